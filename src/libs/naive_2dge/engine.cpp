@@ -48,6 +48,8 @@ namespace naive_2dge
 		fps_counter			fps_			= { 500 };
 		SDL_Window*			window_			= nullptr;
 		SDL_Renderer*		renderer_		= nullptr;
+		SDL_AudioDeviceID	audio_			= 0;
+		audio_callback		on_audio_;
 		SDL_Event           event_;
 		task_list           tasks_;
 		font_map            fonts_;
@@ -63,6 +65,8 @@ namespace naive_2dge
 		void close_image();
 		void close_font();
 		void close_renderer();
+		void close_audio();
+		static void SDLCALL fill_audio(void* userdata, Uint8* stream, int len);
 		void render_texture(render_task const& task, SDL_Texture* texture);
 		void render_rectangle(render_task const& task, rectangle const& rect);
 	};
@@ -74,7 +78,8 @@ namespace naive_2dge
 
 	void engine::impl::init_video()
 	{
-		if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+		// Audio comes up on its own in open_audio, so a machine without sound still gets a window.
+		if (SDL_Init(SDL_INIT_EVERYTHING & ~SDL_INIT_AUDIO) < 0)
 			throw_error("Could not initialise SDL2", SDL_GetError());
 	}
 
@@ -140,6 +145,24 @@ namespace naive_2dge
 		TTF_Quit();
 	}
 
+	void engine::impl::close_audio()
+	{
+		if (audio_)
+		{
+			SDL_CloseAudioDevice(audio_);
+			audio_ = 0;
+		}
+
+		on_audio_ = nullptr;
+	}
+
+	void engine::impl::fill_audio(void* userdata, Uint8* stream, int len)
+	{
+		auto self = static_cast<engine::impl*>(userdata);
+
+		self->on_audio_(reinterpret_cast<std::int16_t*>(stream), len / (2 * sizeof(std::int16_t)));
+	}
+
 	void engine::impl::close_renderer()
 	{
 		if (renderer_)
@@ -162,6 +185,7 @@ namespace naive_2dge
 
 	engine::~engine()
 	{
+		impl_->close_audio();
 		impl_->close_font();
 		impl_->close_image();
 		impl_->close_video();
@@ -210,6 +234,46 @@ namespace naive_2dge
 			throw_error("Unable to set fullscreen", SDL_GetError());
 	}
 
+	std::uint32_t engine::open_audio(std::uint32_t frequency, std::uint16_t frames, audio_callback callback)
+	{
+		impl_->close_audio();
+
+		if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+		{
+			SDL_LogWarn(SDL_LOG_CATEGORY_AUDIO, "Could not initialise audio. Error: %s", SDL_GetError());
+			return 0;
+		}
+
+		SDL_AudioSpec desired = {};
+		SDL_AudioSpec obtained = {};
+
+		desired.freq = static_cast<int>(frequency);
+		desired.format = AUDIO_S16SYS;
+		desired.channels = 2;
+		desired.samples = frames;
+		desired.callback = &engine::impl::fill_audio;
+		desired.userdata = impl_.get();
+
+		impl_->on_audio_ = std::move(callback);
+		impl_->audio_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+
+		if (!impl_->audio_)
+		{
+			SDL_LogWarn(SDL_LOG_CATEGORY_AUDIO, "Could not open audio device. Error: %s", SDL_GetError());
+			impl_->close_audio();
+			return 0;
+		}
+
+		SDL_PauseAudioDevice(impl_->audio_, 0);
+
+		return static_cast<std::uint32_t>(obtained.freq);
+	}
+
+	void engine::close_audio()
+	{
+		impl_->close_audio();
+	}
+
 	void engine::set_assets_dir(std::string const& assets_dir)
 	{
 		impl_->assets_dir_ = assets_dir;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include <naive_2dge/detail/sdl.hpp>
 
 #include <naive_2dge/image.hpp>
@@ -25,6 +26,8 @@ namespace naive_2dge
 
 		};
 
+		using audio_callback = std::function<void(std::int16_t* samples, std::size_t frames)>;
+
         engine();
         virtual ~engine();
 
@@ -56,6 +59,10 @@ namespace naive_2dge
 
 		float get_fps() const;
 
+		std::uint32_t open_audio(std::uint32_t frequency, std::uint16_t frames, audio_callback callback);
+
+		void close_audio();
+
 		image::ptr create_image(const std::string& name, const std::string& path);
 		image::ptr get_image(const std::string& name);
 
@@ -5,51 +5,22 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 //
 #include <naive_gbe/address.hpp>
-
-#include <cassert>
+#include <naive_gbe/mmu.hpp>
 
 namespace naive_gbe
 {
-	address::address(std::uint8_t* data, access_mode mode)
-		: data_(data)
-		, mode_(mode)
-	{
-	}
-
-	void address::set(std::uint8_t* data, access_mode mode)
-	{
-		data_ = data;
-		mode_ = mode;
-	}
-
-	void address::set(callback_type callback)
-	{
-		callback_ = callback;
-	}
-
 	address::operator std::uint8_t() const
 	{
-		if (!data_)
-		{
-			assert(data_ != nullptr);
-			return 0;
-		}
-
-		return *data_;
+		return mmu_.read(addr_);
 	}
 
 	void address::operator=(std::uint8_t value)
 	{
-		if (mode_ == access_mode::READ_ONLY || !data_)
-		{
-			assert(true);
-			return;
-		}
-
-		*data_ = value;
+		mmu_.write(addr_, value);
+	}
 
-		if (callback_)
-			callback_(value);
+	void address::operator=(address const& rhs)
+	{
+		mmu_.write(addr_, rhs);
 	}
 }
-
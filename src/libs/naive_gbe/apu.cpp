@@ -0,0 +1,677 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/apu.hpp>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		std::uint8_t const duty_patterns[] = { 0x01, 0x81, 0x87, 0x7e };
+
+		std::uint8_t const noise_divisors[] = { 8, 16, 32, 48, 64, 80, 96, 112 };
+
+		std::uint8_t const wave_shifts[] = { 4, 0, 1, 2 };
+
+		std::int32_t const channel_unit = apu::VOLUME_UNIT << audio_kernels::MIX_SHIFT;
+	}
+
+	apu::apu(mmu& mmu)
+		: mmu_(mmu)
+	{
+		for (std::uint16_t addr = IO_REG_NR10; addr <= IO_REG_NR52; ++addr)
+			mmu_.set_io_handler(addr, &apu::write_register, this);
+
+		for (std::uint16_t addr = IO_REG_WAVE_FIRST; addr <= IO_REG_WAVE_LAST; ++addr)
+			mmu_.set_io_handler(addr, &apu::write_wave, this);
+
+		for (auto& samples : channel_samples_)
+			samples.resize(blip_buffer::DEFAULT_CAPACITY);
+
+		samples_.resize(blip_buffer::DEFAULT_CAPACITY * audio_ring::NUM_CHANNELS);
+
+		set_sample_rate(DEFAULT_SAMPLE_RATE);
+		reset();
+	}
+
+	void apu::reset()
+	{
+		auto& scheduler = mmu_.get_scheduler();
+
+		channels_.fill(channel{});
+		gains_.fill(0);
+		wave_.fill(0);
+
+		for (auto& buffer : buffers_)
+			buffer.clear();
+
+		frame_start_ = scheduler.get_cycle();
+		cycle_ = frame_start_;
+		enabled_ = false;
+		sequencer_ = 0;
+		sweep_period_ = 0;
+		sweep_timer_ = 8;
+		sweep_shift_ = 0;
+		sweep_negate_ = false;
+		sweep_enabled_ = false;
+		shadow_ = 0;
+		wave_shift_ = 4;
+		lfsr_ = 0x7fff;
+		narrow_ = false;
+
+		update_status();
+
+		scheduler.schedule(scheduler::EVENT_APU, frame_start_ + CYCLES_PER_STEP, &apu::on_event, this);
+	}
+
+	void apu::set_sample_rate(std::uint32_t sample_rate)
+	{
+		sample_rate_ = sample_rate;
+
+		for (auto& buffer : buffers_)
+			buffer.set_rates(CYCLES_PER_SECOND, sample_rate);
+	}
+
+	std::uint32_t apu::get_sample_rate() const
+	{
+		return sample_rate_;
+	}
+
+	audio_ring& apu::get_samples()
+	{
+		return ring_;
+	}
+
+	audio_ring const& apu::get_samples() const
+	{
+		return ring_;
+	}
+
+	bool apu::is_enabled() const
+	{
+		return enabled_;
+	}
+
+	bool apu::is_channel_on(channel_id id) const
+	{
+		return channels_[id].enabled_;
+	}
+
+	void apu::set_isa(audio_kernels::isa isa)
+	{
+		kernels_ = audio_kernels{ isa };
+	}
+
+	audio_kernels::isa apu::get_isa() const
+	{
+		return kernels_.get_isa();
+	}
+
+	void apu::flush()
+	{
+		std::uint64_t cycle = mmu_.get_scheduler().get_cycle();
+
+		run(cycle);
+		end_frame(cycle);
+	}
+
+	void apu::on_event(void* context, std::uint64_t cycle)
+	{
+		auto self = static_cast<apu*>(context);
+
+		self->run(cycle);
+
+		if (self->enabled_)
+			self->step_sequencer();
+
+		self->end_frame(cycle);
+		self->mmu_.get_scheduler().schedule(scheduler::EVENT_APU, cycle + CYCLES_PER_STEP, &apu::on_event, self);
+	}
+
+	void apu::write_register(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<apu*>(context);
+		auto& mmu = self->mmu_;
+		auto& channels = self->channels_;
+
+		self->run(mmu.get_scheduler().get_cycle());
+
+		if (addr == IO_REG_NR52)
+		{
+			self->power((value & 0x80) != 0);
+			return;
+		}
+
+		if (!self->enabled_)
+		{
+			mmu.set_io(addr, 0);
+			return;
+		}
+
+		switch (addr)
+		{
+		case IO_REG_NR10:
+			self->sweep_period_ = (value >> 4) & 0x07;
+			self->sweep_negate_ = (value & 0x08) != 0;
+			self->sweep_shift_ = value & 0x07;
+			break;
+
+		case IO_REG_NR11:
+			channels[CHANNEL_SQUARE1].duty_ = value >> 6;
+			self->write_length(CHANNEL_SQUARE1, value);
+			break;
+
+		case IO_REG_NR12:
+			self->write_envelope(CHANNEL_SQUARE1, value);
+			break;
+
+		case IO_REG_NR13:
+			self->write_frequency(CHANNEL_SQUARE1, value, mmu.get_io(IO_REG_NR14));
+			break;
+
+		case IO_REG_NR14:
+			self->write_frequency(CHANNEL_SQUARE1, mmu.get_io(IO_REG_NR13), value);
+			channels[CHANNEL_SQUARE1].length_enabled_ = (value & 0x40) != 0;
+			if (value & 0x80)
+				self->trigger(CHANNEL_SQUARE1);
+			break;
+
+		case IO_REG_NR21:
+			channels[CHANNEL_SQUARE2].duty_ = value >> 6;
+			self->write_length(CHANNEL_SQUARE2, value);
+			break;
+
+		case IO_REG_NR22:
+			self->write_envelope(CHANNEL_SQUARE2, value);
+			break;
+
+		case IO_REG_NR23:
+			self->write_frequency(CHANNEL_SQUARE2, value, mmu.get_io(IO_REG_NR24));
+			break;
+
+		case IO_REG_NR24:
+			self->write_frequency(CHANNEL_SQUARE2, mmu.get_io(IO_REG_NR23), value);
+			channels[CHANNEL_SQUARE2].length_enabled_ = (value & 0x40) != 0;
+			if (value & 0x80)
+				self->trigger(CHANNEL_SQUARE2);
+			break;
+
+		case IO_REG_NR30:
+			channels[CHANNEL_WAVE].dac_ = (value & 0x80) != 0;
+			if (!channels[CHANNEL_WAVE].dac_)
+				channels[CHANNEL_WAVE].enabled_ = false;
+			break;
+
+		case IO_REG_NR31:
+			self->write_length(CHANNEL_WAVE, value);
+			break;
+
+		case IO_REG_NR32:
+			self->wave_shift_ = wave_shifts[(value >> 5) & 0x03];
+			break;
+
+		case IO_REG_NR33:
+			self->write_frequency(CHANNEL_WAVE, value, mmu.get_io(IO_REG_NR34));
+			break;
+
+		case IO_REG_NR34:
+			self->write_frequency(CHANNEL_WAVE, mmu.get_io(IO_REG_NR33), value);
+			channels[CHANNEL_WAVE].length_enabled_ = (value & 0x40) != 0;
+			if (value & 0x80)
+				self->trigger(CHANNEL_WAVE);
+			break;
+
+		case IO_REG_NR41:
+			self->write_length(CHANNEL_NOISE, value);
+			break;
+
+		case IO_REG_NR42:
+			self->write_envelope(CHANNEL_NOISE, value);
+			break;
+
+		case IO_REG_NR43:
+			self->narrow_ = (value & 0x08) != 0;
+			self->update_period(CHANNEL_NOISE);
+			break;
+
+		case IO_REG_NR44:
+			channels[CHANNEL_NOISE].length_enabled_ = (value & 0x40) != 0;
+			if (value & 0x80)
+				self->trigger(CHANNEL_NOISE);
+			break;
+
+		case IO_REG_NR50:
+		case IO_REG_NR51:
+			self->end_frame(self->cycle_);
+			self->update_gains();
+			break;
+		}
+
+		self->update_status();
+
+		for (std::uint8_t id = 0; id < NUM_CHANNELS; ++id)
+			self->refresh(static_cast<channel_id>(id));
+	}
+
+	void apu::write_wave(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<apu*>(context);
+		std::size_t index = (addr - IO_REG_WAVE_FIRST) * 2;
+
+		self->run(self->mmu_.get_scheduler().get_cycle());
+
+		self->wave_[index] = value >> 4;
+		self->wave_[index + 1] = value & 0x0f;
+
+		self->refresh(CHANNEL_WAVE);
+	}
+
+	void apu::power(bool on)
+	{
+		if (!on && enabled_)
+		{
+			for (std::uint16_t addr = IO_REG_NR10; addr < IO_REG_NR52; ++addr)
+				mmu_.set_io(addr, 0);
+
+			for (auto& ch : channels_)
+			{
+				channel off;
+				off.amplitude_ = ch.amplitude_;
+				ch = off;
+			}
+
+			end_frame(cycle_);
+			gains_.fill(0);
+			sweep_period_ = 0;
+			sweep_shift_ = 0;
+			sweep_negate_ = false;
+			sweep_enabled_ = false;
+			wave_shift_ = 4;
+			narrow_ = false;
+		}
+		else if (on && !enabled_)
+		{
+			sequencer_ = 0;
+		}
+
+		enabled_ = on;
+
+		update_status();
+
+		for (std::uint8_t id = 0; id < NUM_CHANNELS; ++id)
+			refresh(static_cast<channel_id>(id));
+	}
+
+	void apu::run(std::uint64_t cycle)
+	{
+		if (cycle <= cycle_)
+			return;
+
+		cycle_ = cycle;
+
+		if (!enabled_)
+			return;
+
+		run_square(channels_[CHANNEL_SQUARE1], cycle);
+		run_square(channels_[CHANNEL_SQUARE2], cycle);
+		run_wave(cycle);
+		run_noise(cycle);
+	}
+
+	void apu::run_square(channel& ch, std::uint64_t cycle)
+	{
+		if (!ch.enabled_ || ch.next_ > cycle)
+			return;
+
+		std::size_t index = &ch - channels_.data();
+
+		if (!ch.volume_ || !is_audible(index))
+		{
+			std::uint64_t count = (cycle - ch.next_) / ch.period_ + 1;
+
+			ch.position_ = (ch.position_ + count) & 0x07;
+			ch.next_ += count * ch.period_;
+			return;
+		}
+
+		std::uint8_t pattern = duty_patterns[ch.duty_];
+
+		while (ch.next_ <= cycle)
+		{
+			ch.position_ = (ch.position_ + 1) & 0x07;
+			set_level(ch, index, ch.next_, ((pattern >> ch.position_) & 1) ? ch.volume_ : 0);
+			ch.next_ += ch.period_;
+		}
+	}
+
+	void apu::run_wave(std::uint64_t cycle)
+	{
+		auto& ch = channels_[CHANNEL_WAVE];
+
+		if (!ch.enabled_ || ch.next_ > cycle)
+			return;
+
+		if (wave_shift_ > 3 || !is_audible(CHANNEL_WAVE))
+		{
+			std::uint64_t count = (cycle - ch.next_) / ch.period_ + 1;
+
+			ch.position_ = (ch.position_ + count) % WAVE_SAMPLES;
+			ch.next_ += count * ch.period_;
+			return;
+		}
+
+		while (ch.next_ <= cycle)
+		{
+			ch.position_ = (ch.position_ + 1) % WAVE_SAMPLES;
+			set_level(ch, CHANNEL_WAVE, ch.next_, wave_[ch.position_] >> wave_shift_);
+			ch.next_ += ch.period_;
+		}
+	}
+
+	void apu::run_noise(std::uint64_t cycle)
+	{
+		auto& ch = channels_[CHANNEL_NOISE];
+
+		if (!ch.enabled_ || !ch.period_ || ch.next_ > cycle)
+			return;
+
+		bool audible = ch.volume_ && is_audible(CHANNEL_NOISE);
+		std::uint16_t lfsr = lfsr_;
+
+		while (ch.next_ <= cycle)
+		{
+			std::uint16_t bit = (lfsr ^ (lfsr >> 1)) & 1;
+
+			lfsr = (lfsr >> 1) | (bit << 14);
+
+			if (narrow_)
+				lfsr = (lfsr & ~0x40) | (bit << 6);
+
+			if (audible)
+				set_level(ch, CHANNEL_NOISE, ch.next_, (lfsr & 1) ? 0 : ch.volume_);
+
+			ch.next_ += ch.period_;
+		}
+
+		lfsr_ = lfsr;
+	}
+
+	void apu::step_sequencer()
+	{
+		if (!(sequencer_ & 1))
+		{
+			for (auto& ch : channels_)
+				clock_length(ch);
+		}
+
+		if (sequencer_ == 2 || sequencer_ == 6)
+			clock_sweep();
+
+		if (sequencer_ == 7)
+		{
+			clock_envelope(channels_[CHANNEL_SQUARE1]);
+			clock_envelope(channels_[CHANNEL_SQUARE2]);
+			clock_envelope(channels_[CHANNEL_NOISE]);
+		}
+
+		sequencer_ = (sequencer_ + 1) & 0x07;
+
+		update_status();
+
+		for (std::uint8_t id = 0; id < NUM_CHANNELS; ++id)
+			refresh(static_cast<channel_id>(id));
+	}
+
+	void apu::clock_length(channel& ch)
+	{
+		if (ch.length_enabled_ && ch.length_ && --ch.length_ == 0)
+			ch.enabled_ = false;
+	}
+
+	void apu::clock_envelope(channel& ch)
+	{
+		std::uint8_t period = ch.envelope_ & 0x07;
+
+		if (!period || !ch.enabled_ || --ch.env_timer_)
+			return;
+
+		ch.env_timer_ = period;
+
+		if ((ch.envelope_ & 0x08) && ch.volume_ < 15)
+			++ch.volume_;
+		else if (!(ch.envelope_ & 0x08) && ch.volume_ > 0)
+			--ch.volume_;
+	}
+
+	void apu::clock_sweep()
+	{
+		if (--sweep_timer_)
+			return;
+
+		sweep_timer_ = sweep_period_ ? sweep_period_ : 8;
+
+		if (!sweep_enabled_ || !sweep_period_)
+			return;
+
+		std::uint16_t frequency = compute_sweep();
+
+		if (frequency > 2047 || !sweep_shift_)
+			return;
+
+		auto& ch = channels_[CHANNEL_SQUARE1];
+
+		shadow_ = frequency;
+		ch.frequency_ = frequency;
+		update_period(CHANNEL_SQUARE1);
+
+		mmu_.set_io(IO_REG_NR13, frequency & 0xff);
+		mmu_.set_io(IO_REG_NR14, (mmu_.get_io(IO_REG_NR14) & 0xf8) | (frequency >> 8));
+
+		compute_sweep();
+	}
+
+	std::uint16_t apu::compute_sweep()
+	{
+		std::uint16_t delta = shadow_ >> sweep_shift_;
+		std::uint16_t frequency = sweep_negate_ ? shadow_ - delta : shadow_ + delta;
+
+		if (frequency > 2047)
+			channels_[CHANNEL_SQUARE1].enabled_ = false;
+
+		return frequency;
+	}
+
+	void apu::trigger(channel_id id)
+	{
+		auto& ch = channels_[id];
+
+		ch.enabled_ = ch.dac_;
+
+		if (!ch.length_)
+			ch.length_ = id == CHANNEL_WAVE ? 256 : 64;
+
+		ch.volume_ = ch.envelope_ >> 4;
+		ch.env_timer_ = (ch.envelope_ & 0x07) ? (ch.envelope_ & 0x07) : 8;
+
+		update_period(id);
+		ch.next_ = cycle_ + ch.period_;
+
+		if (id == CHANNEL_WAVE)
+			ch.position_ = 0;
+
+		if (id == CHANNEL_NOISE)
+			lfsr_ = 0x7fff;
+
+		if (id == CHANNEL_SQUARE1)
+		{
+			shadow_ = ch.frequency_;
+			sweep_timer_ = sweep_period_ ? sweep_period_ : 8;
+			sweep_enabled_ = sweep_period_ || sweep_shift_;
+
+			if (sweep_shift_)
+				compute_sweep();
+		}
+	}
+
+	void apu::write_length(channel_id id, std::uint8_t value)
+	{
+		if (id == CHANNEL_WAVE)
+			channels_[id].length_ = 256 - value;
+		else
+			channels_[id].length_ = 64 - (value & 0x3f);
+	}
+
+	void apu::write_envelope(channel_id id, std::uint8_t value)
+	{
+		auto& ch = channels_[id];
+
+		ch.envelope_ = value;
+		ch.dac_ = (value & 0xf8) != 0;
+
+		if (!ch.dac_)
+			ch.enabled_ = false;
+	}
+
+	void apu::write_frequency(channel_id id, std::uint8_t low, std::uint8_t high)
+	{
+		channels_[id].frequency_ = low | ((high & 0x07) << 8);
+		update_period(id);
+	}
+
+	void apu::update_period(channel_id id)
+	{
+		auto& ch = channels_[id];
+
+		switch (id)
+		{
+		case CHANNEL_SQUARE1:
+		case CHANNEL_SQUARE2:
+			ch.period_ = (2048 - ch.frequency_) * 4;
+			break;
+
+		case CHANNEL_WAVE:
+			ch.period_ = (2048 - ch.frequency_) * 2;
+			break;
+
+		default:
+		{
+			std::uint8_t nr43 = mmu_.get_io(IO_REG_NR43);
+			std::uint8_t shift = nr43 >> 4;
+			bool frozen = !ch.period_;
+
+			ch.period_ = shift < 14 ? noise_divisors[nr43 & 0x07] << shift : 0;
+
+			if (frozen)
+				ch.next_ = cycle_ + ch.period_;
+			break;
+		}
+		}
+	}
+
+	void apu::update_gains()
+	{
+		std::uint8_t nr50 = mmu_.get_io(IO_REG_NR50);
+		std::uint8_t nr51 = mmu_.get_io(IO_REG_NR51);
+		std::int16_t left = ((nr50 >> 4) & 0x07) + 1;
+		std::int16_t right = (nr50 & 0x07) + 1;
+
+		for (std::size_t id = 0; id < NUM_CHANNELS; ++id)
+		{
+			gains_[id] = ((nr51 >> (id + 4)) & 1) ? left : 0;
+			gains_[NUM_CHANNELS + id] = ((nr51 >> id) & 1) ? right : 0;
+		}
+	}
+
+	bool apu::is_audible(std::size_t index) const
+	{
+		return gains_[index] || gains_[NUM_CHANNELS + index];
+	}
+
+	void apu::update_status()
+	{
+		std::uint8_t status = enabled_ ? 0xf0 : 0x70;
+
+		for (std::size_t id = 0; id < NUM_CHANNELS; ++id)
+		{
+			if (channels_[id].enabled_)
+				status |= 1 << id;
+		}
+
+		mmu_.set_io(IO_REG_NR52, status);
+	}
+
+	void apu::set_level(channel& ch, std::size_t index, std::uint64_t cycle, std::uint8_t level)
+	{
+		std::int32_t amplitude = level * channel_unit;
+
+		if (amplitude != ch.amplitude_)
+		{
+			buffers_[index].add_delta(get_time(cycle), amplitude - ch.amplitude_);
+			ch.amplitude_ = amplitude;
+		}
+	}
+
+	void apu::refresh(channel_id id)
+	{
+		set_level(channels_[id], id, cycle_, get_level(id));
+	}
+
+	std::uint8_t apu::get_level(channel_id id) const
+	{
+		auto const& ch = channels_[id];
+
+		if (!ch.enabled_ || !ch.dac_)
+			return 0;
+
+		switch (id)
+		{
+		case CHANNEL_SQUARE1:
+		case CHANNEL_SQUARE2:
+			return ((duty_patterns[ch.duty_] >> ch.position_) & 1) ? ch.volume_ : 0;
+
+		case CHANNEL_WAVE:
+			return wave_[ch.position_] >> wave_shift_;
+
+		default:
+			return (lfsr_ & 1) ? 0 : ch.volume_;
+		}
+	}
+
+	std::uint32_t apu::get_time(std::uint64_t cycle) const
+	{
+		return static_cast<std::uint32_t>(cycle - frame_start_);
+	}
+
+	void apu::end_frame(std::uint64_t cycle)
+	{
+		if (cycle < frame_start_)
+			return;
+
+		std::uint32_t time = get_time(cycle);
+
+		for (auto& buffer : buffers_)
+			buffer.end_frame(time);
+
+		frame_start_ = cycle;
+
+		std::size_t count = buffers_[0].get_available();
+
+		if (!count)
+			return;
+
+		audio_kernels::channel_samples channels;
+
+		for (std::size_t id = 0; id < NUM_CHANNELS; ++id)
+		{
+			buffers_[id].read(channel_samples_[id].data(), count, 1);
+			channels[id] = channel_samples_[id].data();
+		}
+
+		kernels_.mix(channels, count, gains_, samples_.data());
+
+		ring_.write(samples_.data(), count);
+	}
+}
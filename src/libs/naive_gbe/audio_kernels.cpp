@@ -0,0 +1,179 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/audio_kernels.hpp>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define NAIVE_GBE_X86 1
+	#include <immintrin.h>
+#else
+	#define NAIVE_GBE_X86 0
+#endif
+
+#if defined(__GNUC__)
+	#define NAIVE_GBE_TARGET(name) __attribute__((target(name)))
+#else
+	#define NAIVE_GBE_TARGET(name)
+#endif
+
+namespace naive_gbe
+{
+	namespace
+	{
+		using channel_samples = audio_kernels::channel_samples;
+
+		using mix_gains = audio_kernels::mix_gains;
+
+		void mix_scalar(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::int32_t left = 0;
+				std::int32_t right = 0;
+
+				for (std::size_t ch = 0; ch < audio_kernels::NUM_CHANNELS; ++ch)
+				{
+					left += channels[ch][i] * gains[ch];
+					right += channels[ch][i] * gains[audio_kernels::NUM_CHANNELS + ch];
+				}
+
+				out[i * 2] = static_cast<std::int16_t>(std::clamp(left >> audio_kernels::MIX_SHIFT, INT16_MIN, INT16_MAX));
+				out[i * 2 + 1] = static_cast<std::int16_t>(std::clamp(right >> audio_kernels::MIX_SHIFT, INT16_MIN, INT16_MAX));
+			}
+		}
+
+#if NAIVE_GBE_X86
+		NAIVE_GBE_TARGET("sse2")
+		void mix_sse2(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out)
+		{
+			const __m128i left01 = _mm_set1_epi32((gains[1] << 16) | static_cast<std::uint16_t>(gains[0]));
+			const __m128i left23 = _mm_set1_epi32((gains[3] << 16) | static_cast<std::uint16_t>(gains[2]));
+			const __m128i right01 = _mm_set1_epi32((gains[5] << 16) | static_cast<std::uint16_t>(gains[4]));
+			const __m128i right23 = _mm_set1_epi32((gains[7] << 16) | static_cast<std::uint16_t>(gains[6]));
+
+			std::size_t i = 0;
+
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i c0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(channels[0] + i));
+				__m128i c1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(channels[1] + i));
+				__m128i c2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(channels[2] + i));
+				__m128i c3 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(channels[3] + i));
+
+				__m128i lo01 = _mm_unpacklo_epi16(c0, c1);
+				__m128i hi01 = _mm_unpackhi_epi16(c0, c1);
+				__m128i lo23 = _mm_unpacklo_epi16(c2, c3);
+				__m128i hi23 = _mm_unpackhi_epi16(c2, c3);
+
+				__m128i left_lo = _mm_add_epi32(_mm_madd_epi16(lo01, left01), _mm_madd_epi16(lo23, left23));
+				__m128i left_hi = _mm_add_epi32(_mm_madd_epi16(hi01, left01), _mm_madd_epi16(hi23, left23));
+				__m128i right_lo = _mm_add_epi32(_mm_madd_epi16(lo01, right01), _mm_madd_epi16(lo23, right23));
+				__m128i right_hi = _mm_add_epi32(_mm_madd_epi16(hi01, right01), _mm_madd_epi16(hi23, right23));
+
+				left_lo = _mm_srai_epi32(left_lo, audio_kernels::MIX_SHIFT);
+				left_hi = _mm_srai_epi32(left_hi, audio_kernels::MIX_SHIFT);
+				right_lo = _mm_srai_epi32(right_lo, audio_kernels::MIX_SHIFT);
+				right_hi = _mm_srai_epi32(right_hi, audio_kernels::MIX_SHIFT);
+
+				__m128i first = _mm_packs_epi32(_mm_unpacklo_epi32(left_lo, right_lo), _mm_unpackhi_epi32(left_lo, right_lo));
+				__m128i second = _mm_packs_epi32(_mm_unpacklo_epi32(left_hi, right_hi), _mm_unpackhi_epi32(left_hi, right_hi));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), first);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 8), second);
+			}
+
+			channel_samples rest = { channels[0] + i, channels[1] + i, channels[2] + i, channels[3] + i };
+
+			mix_scalar(rest, count - i, gains, out + i * 2);
+		}
+
+		NAIVE_GBE_TARGET("avx2")
+		void mix_avx2(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out)
+		{
+			const __m256i left01 = _mm256_set1_epi32((gains[1] << 16) | static_cast<std::uint16_t>(gains[0]));
+			const __m256i left23 = _mm256_set1_epi32((gains[3] << 16) | static_cast<std::uint16_t>(gains[2]));
+			const __m256i right01 = _mm256_set1_epi32((gains[5] << 16) | static_cast<std::uint16_t>(gains[4]));
+			const __m256i right23 = _mm256_set1_epi32((gains[7] << 16) | static_cast<std::uint16_t>(gains[6]));
+
+			std::size_t i = 0;
+
+			for (; i + 16 <= count; i += 16)
+			{
+				__m256i c0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(channels[0] + i));
+				__m256i c1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(channels[1] + i));
+				__m256i c2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(channels[2] + i));
+				__m256i c3 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(channels[3] + i));
+
+				__m256i lo01 = _mm256_unpacklo_epi16(c0, c1);
+				__m256i hi01 = _mm256_unpackhi_epi16(c0, c1);
+				__m256i lo23 = _mm256_unpacklo_epi16(c2, c3);
+				__m256i hi23 = _mm256_unpackhi_epi16(c2, c3);
+
+				__m256i left_lo = _mm256_add_epi32(_mm256_madd_epi16(lo01, left01), _mm256_madd_epi16(lo23, left23));
+				__m256i left_hi = _mm256_add_epi32(_mm256_madd_epi16(hi01, left01), _mm256_madd_epi16(hi23, left23));
+				__m256i right_lo = _mm256_add_epi32(_mm256_madd_epi16(lo01, right01), _mm256_madd_epi16(lo23, right23));
+				__m256i right_hi = _mm256_add_epi32(_mm256_madd_epi16(hi01, right01), _mm256_madd_epi16(hi23, right23));
+
+				left_lo = _mm256_srai_epi32(left_lo, audio_kernels::MIX_SHIFT);
+				left_hi = _mm256_srai_epi32(left_hi, audio_kernels::MIX_SHIFT);
+				right_lo = _mm256_srai_epi32(right_lo, audio_kernels::MIX_SHIFT);
+				right_hi = _mm256_srai_epi32(right_hi, audio_kernels::MIX_SHIFT);
+
+				// Each 128-bit lane holds samples 0-3/8-11 (lo) and 4-7/12-15 (hi).
+				__m256i lo = _mm256_packs_epi32(_mm256_unpacklo_epi32(left_lo, right_lo), _mm256_unpackhi_epi32(left_lo, right_lo));
+				__m256i hi = _mm256_packs_epi32(_mm256_unpacklo_epi32(left_hi, right_hi), _mm256_unpackhi_epi32(left_hi, right_hi));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+			}
+
+			channel_samples rest = { channels[0] + i, channels[1] + i, channels[2] + i, channels[3] + i };
+
+			mix_sse2(rest, count - i, gains, out + i * 2);
+		}
+#endif
+	}
+
+	audio_kernels::audio_kernels()
+		: audio_kernels(isa::AVX2)
+	{
+	}
+
+	audio_kernels::audio_kernels(isa isa)
+	{
+		while (!is_supported(isa))
+			isa = static_cast<audio_kernels::isa>(static_cast<std::uint8_t>(isa) - 1);
+
+		isa_ = isa;
+
+		switch (isa)
+		{
+#if NAIVE_GBE_X86
+		case isa::AVX2:
+			mix_ = &mix_avx2;
+			break;
+		case isa::SSE2:
+			mix_ = &mix_sse2;
+			break;
+#endif
+		default:
+			mix_ = &mix_scalar;
+			break;
+		}
+	}
+
+	audio_kernels::isa audio_kernels::get_isa() const
+	{
+		return isa_;
+	}
+
+	bool audio_kernels::is_supported(isa isa)
+	{
+		return pixel_kernels::is_supported(isa);
+	}
+}
@@ -0,0 +1,101 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/audio_ring.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace naive_gbe
+{
+	audio_ring::audio_ring(std::size_t capacity)
+		: head_{ 0 }
+		, tail_{ 0 }
+		, overruns_{ 0 }
+		, underruns_{ 0 }
+	{
+		std::size_t frames = 1;
+
+		while (frames < capacity)
+			frames <<= 1;
+
+		samples_.assign(frames * NUM_CHANNELS, 0);
+		mask_ = frames - 1;
+	}
+
+	std::size_t audio_ring::get_capacity() const
+	{
+		return mask_ + 1;
+	}
+
+	std::size_t audio_ring::get_available() const
+	{
+		return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+	}
+
+	std::size_t audio_ring::write(std::int16_t const* samples, std::size_t frames)
+	{
+		std::size_t head = head_.load(std::memory_order_relaxed);
+		std::size_t tail = tail_.load(std::memory_order_acquire);
+		std::size_t count = std::min(frames, get_capacity() - (head - tail));
+
+		for (std::size_t done = 0; done < count; )
+		{
+			std::size_t index = (head + done) & mask_;
+			std::size_t chunk = std::min(count - done, get_capacity() - index);
+
+			std::memcpy(&samples_[index * NUM_CHANNELS], samples + done * NUM_CHANNELS,
+				chunk * NUM_CHANNELS * sizeof(std::int16_t));
+
+			done += chunk;
+		}
+
+		head_.store(head + count, std::memory_order_release);
+
+		if (count < frames)
+			overruns_.fetch_add(frames - count, std::memory_order_relaxed);
+
+		return count;
+	}
+
+	std::size_t audio_ring::read(std::int16_t* samples, std::size_t frames)
+	{
+		std::size_t tail = tail_.load(std::memory_order_relaxed);
+		std::size_t head = head_.load(std::memory_order_acquire);
+		std::size_t count = std::min(frames, head - tail);
+
+		for (std::size_t done = 0; done < count; )
+		{
+			std::size_t index = (tail + done) & mask_;
+			std::size_t chunk = std::min(count - done, get_capacity() - index);
+
+			std::memcpy(samples + done * NUM_CHANNELS, &samples_[index * NUM_CHANNELS],
+				chunk * NUM_CHANNELS * sizeof(std::int16_t));
+
+			done += chunk;
+		}
+
+		tail_.store(tail + count, std::memory_order_release);
+
+		if (count < frames)
+		{
+			std::memset(samples + count * NUM_CHANNELS, 0, (frames - count) * NUM_CHANNELS * sizeof(std::int16_t));
+			underruns_.fetch_add(frames - count, std::memory_order_relaxed);
+		}
+
+		return count;
+	}
+
+	std::size_t audio_ring::get_overruns() const
+	{
+		return overruns_.load(std::memory_order_relaxed);
+	}
+
+	std::size_t audio_ring::get_underruns() const
+	{
+		return underruns_.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,269 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/batch_runner.hpp>
+#include <naive_gbe/headless_runner.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		bool is_absolute(std::string const& path)
+		{
+			return (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+		}
+
+		std::string resolve(std::string const& base_dir, std::string const& path)
+		{
+			if (base_dir.empty() || is_absolute(path))
+				return path;
+
+			return base_dir + '/' + path;
+		}
+
+		std::string quote(std::string const& text)
+		{
+			std::ostringstream out;
+
+			out << '"';
+
+			for (char ch : text)
+			{
+				switch (ch)
+				{
+				case '"':
+					out << "\\\"";
+					break;
+				case '\\':
+					out << "\\\\";
+					break;
+				case '\n':
+					out << "\\n";
+					break;
+				case '\t':
+					out << "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(ch) < 0x20)
+						out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(ch) << std::dec;
+					else
+						out << ch;
+				}
+			}
+
+			out << '"';
+
+			return out.str();
+		}
+	}
+
+	batch_runner::batch_runner(std::size_t num_threads)
+		: pool_(std::max<std::size_t>(num_threads, 1) - 1)
+	{
+	}
+
+	std::size_t batch_runner::get_num_threads() const
+	{
+		return pool_.get_num_threads() + 1;
+	}
+
+	batch_runner::result_list batch_runner::run(job_list const& jobs, result_handler const& on_result)
+	{
+		result_list results(jobs.size());
+		std::vector<std::size_t> order(jobs.size());
+		std::mutex mutex;
+
+		// Longest jobs start first so a long tail does not leave the other cores idle at the end.
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+			[&jobs](std::size_t lhs, std::size_t rhs) { return jobs[lhs].frames_ > jobs[rhs].frames_; });
+
+		pool_.run(jobs.size(), [&](std::size_t slot)
+		{
+			std::size_t index = order[slot];
+			auto& result = results[index];
+
+			// A throwing job only fails its own entry; escaping the worker would terminate the batch.
+			try
+			{
+				result = run_job(jobs[index]);
+			}
+			catch (std::system_error const& e)
+			{
+				result = batch_runner::result{};
+				result.error_ = e.code();
+			}
+			catch (std::bad_alloc const&)
+			{
+				result = batch_runner::result{};
+				result.error_ = std::make_error_code(std::errc::not_enough_memory);
+			}
+			catch (...)
+			{
+				result = batch_runner::result{};
+				result.error_ = std::make_error_code(std::errc::state_not_recoverable);
+			}
+
+			result.index_ = index;
+
+			if (on_result)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				on_result(jobs[index], result);
+			}
+		});
+
+		return results;
+	}
+
+	batch_runner::result batch_runner::run_job(job const& job)
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto emu = std::make_unique<emulator>();
+		result result;
+		cartridge cartridge;
+		movie movie;
+
+		// Cartridges are loaded without their save files, so parallel jobs never share battery RAM.
+		if (!cartridge.load(job.rom_path_, result.error_))
+			return result;
+
+		emu->set_cartridge(std::move(cartridge));
+		result.frames_ = job.frames_;
+
+		if (!job.movie_path_.empty())
+		{
+			if (!movie.load(job.movie_path_, result.error_) || !emu->play_movie(movie, result.error_))
+				return result;
+
+			if (!result.frames_)
+				result.frames_ = movie.get_num_frames();
+		}
+
+		headless_runner runner{ *emu };
+
+		for (std::size_t frame = 0; frame < result.frames_; ++frame)
+			runner.run_frame();
+
+		emu->stop_movie();
+
+		result.frame_hash_ = emu->get_ppu().get_frame_hash();
+		result.cycles_ = emu->get_cpu().get_cycle();
+		result.wall_time_ = std::chrono::steady_clock::now() - start;
+
+		auto const& recorded = movie.get_result();
+
+		if (!job.movie_path_.empty() && recorded.cycle_ && result.frames_ == movie.get_num_frames())
+		{
+			result.checked_ = true;
+			result.desync_ = recorded.cycle_ != result.cycles_ || recorded.frame_hash_ != result.frame_hash_;
+		}
+
+		return result;
+	}
+
+	std::size_t batch_runner::get_default_threads()
+	{
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	bool batch_runner::load_manifest(std::string const& file_name, job_list& jobs, std::error_code& ec)
+	{
+		std::ifstream ifs(file_name);
+
+		if (!ifs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		std::ostringstream oss;
+		oss << ifs.rdbuf();
+
+		auto sep = file_name.find_last_of("\\/");
+		std::string base_dir = sep == std::string::npos ? std::string{} : file_name.substr(0, sep);
+
+		return parse_manifest(oss.str(), base_dir, jobs, ec);
+	}
+
+	bool batch_runner::parse_manifest(std::string const& text, std::string const& base_dir, job_list& jobs, std::error_code& ec)
+	{
+		std::istringstream iss(text);
+		std::string line;
+		job_list result;
+
+		while (std::getline(iss, line))
+		{
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream fields(line);
+			std::string extra;
+			job job;
+
+			if (!(fields >> job.rom_path_))
+				continue;
+
+			if (!(fields >> job.frames_) || (fields >> job.movie_path_ && fields >> extra)
+				|| (!job.frames_ && job.movie_path_.empty()))
+			{
+				ec = std::make_error_code(std::errc::invalid_argument);
+				return false;
+			}
+
+			job.rom_path_ = resolve(base_dir, job.rom_path_);
+
+			if (!job.movie_path_.empty())
+				job.movie_path_ = resolve(base_dir, job.movie_path_);
+
+			result.push_back(std::move(job));
+		}
+
+		jobs = std::move(result);
+
+		return true;
+	}
+
+	std::string batch_runner::to_json(job const& job, result const& result)
+	{
+		std::ostringstream out;
+
+		out << "{\"job\":" << result.index_
+			<< ",\"rom\":" << quote(job.rom_path_);
+
+		if (!job.movie_path_.empty())
+			out << ",\"movie\":" << quote(job.movie_path_);
+
+		if (result.error_)
+		{
+			out << ",\"error\":" << quote(result.error_.message()) << '}';
+			return out.str();
+		}
+
+		out << ",\"frames\":" << result.frames_
+			<< ",\"frame_hash\":\"" << std::hex << std::setw(16) << std::setfill('0') << result.frame_hash_ << std::dec << '"'
+			<< ",\"cycles\":" << result.cycles_
+			<< ",\"wall_ms\":" << std::fixed << std::setprecision(3)
+			<< std::chrono::duration<double, std::milli>(result.wall_time_).count();
+
+		if (result.checked_)
+			out << ",\"desync\":" << (result.desync_ ? "true" : "false");
+
+		out << '}';
+
+		return out.str();
+	}
+}
@@ -0,0 +1,136 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/blip_buffer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace naive_gbe
+{
+	blip_buffer::blip_buffer(std::size_t capacity)
+		: capacity_(capacity)
+	{
+		buffer_.assign(capacity_ + NUM_TAPS, 0);
+		set_rates(4194304, 48000);
+	}
+
+	void blip_buffer::set_rates(std::uint32_t clock_rate, std::uint32_t sample_rate)
+	{
+		factor_ = ((static_cast<std::uint64_t>(sample_rate) << FRAC_BITS) + clock_rate / 2) / clock_rate;
+		clear();
+	}
+
+	void blip_buffer::clear()
+	{
+		std::fill(buffer_.begin(), buffer_.end(), 0);
+		offset_ = 0;
+		integral_ = 0;
+	}
+
+	void blip_buffer::add_delta(std::uint32_t time, std::int32_t delta)
+	{
+		std::uint64_t position = offset_ + time * factor_;
+		std::size_t index = static_cast<std::size_t>(position >> FRAC_BITS);
+
+		if (index >= capacity_)
+			return;
+
+		auto const& taps = get_kernel()[(position >> (FRAC_BITS - PHASE_BITS)) & (NUM_PHASES - 1)];
+		std::int32_t* out = &buffer_[index];
+
+		for (std::size_t tap = 0; tap < NUM_TAPS; ++tap)
+			out[tap] += taps[tap] * delta;
+	}
+
+	void blip_buffer::end_frame(std::uint32_t time)
+	{
+		offset_ += time * factor_;
+	}
+
+	std::size_t blip_buffer::get_available() const
+	{
+		return std::min(static_cast<std::size_t>(offset_ >> FRAC_BITS), capacity_);
+	}
+
+	std::size_t blip_buffer::read(std::int16_t* out, std::size_t count, std::size_t stride)
+	{
+		std::size_t available = get_available();
+
+		count = std::min(count, available);
+
+		std::int64_t integral = integral_;
+
+		for (std::size_t index = 0; index < count; ++index)
+		{
+			integral += buffer_[index];
+
+			std::int64_t sample = integral >> KERNEL_BITS;
+
+			out[index * stride] = static_cast<std::int16_t>(std::clamp<std::int64_t>(sample, INT16_MIN, INT16_MAX));
+
+			integral -= integral >> BASS_SHIFT;
+		}
+
+		integral_ = integral;
+
+		std::size_t remaining = available - count + NUM_TAPS;
+
+		std::memmove(buffer_.data(), buffer_.data() + count, remaining * sizeof(std::int32_t));
+		std::fill(buffer_.begin() + remaining, buffer_.begin() + remaining + count, 0);
+
+		offset_ -= static_cast<std::uint64_t>(count) << FRAC_BITS;
+
+		return count;
+	}
+
+	blip_buffer::kernel const& blip_buffer::get_kernel()
+	{
+		static kernel const table = []
+		{
+			double const pi = 3.14159265358979323846;
+			double const cutoff = 0.94;
+			double const half = NUM_TAPS / 2.0;
+
+			kernel result{};
+
+			for (std::size_t phase = 0; phase < NUM_PHASES; ++phase)
+			{
+				std::array<double, NUM_TAPS> taps;
+				double sum = 0;
+
+				for (std::size_t tap = 0; tap < NUM_TAPS; ++tap)
+				{
+					double x = tap - (half - 1) - static_cast<double>(phase) / NUM_PHASES;
+					double sinc = x == 0 ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+					double window = 0.5 + 0.5 * std::cos(pi * x / half);
+
+					taps[tap] = sinc * window;
+					sum += taps[tap];
+				}
+
+				std::int32_t total = 0;
+				std::size_t peak = 0;
+
+				for (std::size_t tap = 0; tap < NUM_TAPS; ++tap)
+				{
+					result[phase][tap] = static_cast<std::int32_t>(std::lround(taps[tap] / sum * (1 << KERNEL_BITS)));
+					total += result[phase][tap];
+
+					if (result[phase][tap] > result[phase][peak])
+						peak = tap;
+				}
+
+				result[phase][peak] += (1 << KERNEL_BITS) - total;
+			}
+
+			return result;
+		}();
+
+		return table;
+	}
+}
@@ -33,3 +33,49 @@ buffer& cartridge::get_data()
 {
 	return data_;
 }
+
+std::uint8_t cartridge::get_type() const
+{
+	return data_.size() > HEADER_TYPE ? data_[HEADER_TYPE] : 0;
+}
+
+bool cartridge::has_battery() const
+{
+	switch (get_type())
+	{
+	case 0x03:	// MBC1+RAM+BATTERY
+	case 0x06:	// MBC2+BATTERY
+	case 0x09:	// ROM+RAM+BATTERY
+	case 0x0d:	// MMM01+RAM+BATTERY
+	case 0x0f:	// MBC3+TIMER+BATTERY
+	case 0x10:	// MBC3+TIMER+RAM+BATTERY
+	case 0x13:	// MBC3+RAM+BATTERY
+	case 0x1b:	// MBC5+RAM+BATTERY
+	case 0x1e:	// MBC5+RUMBLE+RAM+BATTERY
+		return true;
+	}
+
+	return false;
+}
+
+std::size_t cartridge::get_ram_size() const
+{
+	if (data_.size() <= HEADER_RAM_SIZE)
+		return 0;
+
+	switch (data_[HEADER_RAM_SIZE])
+	{
+	case 0x01:
+		return 0x0800;
+	case 0x02:
+		return 0x2000;
+	case 0x03:
+		return 0x8000;
+	case 0x04:
+		return 0x20000;
+	case 0x05:
+		return 0x10000;
+	}
+
+	return 0;
+}
@@ -24,6 +24,8 @@ namespace naive_gbe
 		: mmu_(mmu)
 		, ppu_(ppu)
 	{
+		mmu_.set_pc_source([this] { return get_register(r16::PC); });
+
 		reset();
 		set_daa_table();
 		set_operation_table();
@@ -78,14 +80,39 @@ namespace naive_gbe
 		return registers_[(std::uint8_t)index] << 8 | registers_[(std::uint8_t)index + 1];
 	}
 
+	lr35902::register_file const& lr35902::get_registers() const
+	{
+		return registers_;
+	}
+
+	void lr35902::set_registers(register_file const& registers, std::size_t cycle)
+	{
+		registers_ = registers;
+		cycle_ = cycle;
+	}
+
+	std::uint8_t lr35902::get_cycles(std::uint8_t opcode) const
+	{
+		return ops_[opcode].cycles_;
+	}
+
 	void lr35902::step(operations& ops, bool extended)
 	{
-		auto& op = ops[fetch_u8()];
+		auto& op = ops[fetch_opcode()];
 
 		op.func_();
 
 		cycle_ += op.cycles_;
-		ppu_.run(cycle_);
+		mmu_.get_scheduler().run(cycle_);
+	}
+
+	std::uint8_t lr35902::fetch_opcode()
+	{
+		std::uint16_t addr = get_register(r16::PC);
+
+		set_register(r16::PC, addr + 1);
+
+		return mmu_.fetch(addr);
 	}
 
 	std::uint8_t lr35902::fetch_u8()
@@ -132,7 +159,7 @@ namespace naive_gbe
 		return std::ref(registers_[(std::uint8_t)reg]);
 	}
 
-	address& lr35902::get_hl_ref()
+	address lr35902::get_hl_ref()
 	{
 		return mmu_[get_register(r16::HL)];
 	}
@@ -225,7 +252,7 @@ namespace naive_gbe
 			flags |= flags::ZERO;
 	}
 
-	void lr35902::left_rotate(address& addr, std::uint8_t& flags)
+	void lr35902::left_rotate(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -245,7 +272,7 @@ namespace naive_gbe
 		set_zero_flag(value, flags);
 	}
 
-	void lr35902::left_rotate_carry(address& addr, std::uint8_t& flags)
+	void lr35902::left_rotate_carry(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -267,7 +294,7 @@ namespace naive_gbe
 		set_zero_flag(value, flags);
 	}
 
-	void lr35902::increment(address& addr, std::uint8_t& flags)
+	void lr35902::increment(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 		increment(value, flags);
@@ -283,7 +310,7 @@ namespace naive_gbe
 		set_half_carry_and_zero_flags(value, flags);
 	}
 
-	void lr35902::decrement(address& addr, std::uint8_t& flags)
+	void lr35902::decrement(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 		decrement(value, flags);
@@ -299,7 +326,7 @@ namespace naive_gbe
 		set_half_carry_and_zero_flags(value, flags);
 	}
 
-	void lr35902::add(address& lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags)
+	void lr35902::add(address lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags)
 	{
 		std::uint8_t value = lhs;
 		add(value, rhs, carry, flags);
@@ -332,7 +359,7 @@ namespace naive_gbe
 		set_zero_flag(lhs, flags);
 	}
 
-	void lr35902::right_rotate(address& addr, std::uint8_t& flags)
+	void lr35902::right_rotate(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -352,7 +379,7 @@ namespace naive_gbe
 		set_zero_flag(value, flags);
 	}
 
-	void lr35902::right_rotate_carry(address& addr, std::uint8_t& flags)
+	void lr35902::right_rotate_carry(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -374,7 +401,7 @@ namespace naive_gbe
 		set_zero_flag(value, flags);
 	}
 
-	void lr35902::left_shift_u8(address& addr, std::uint8_t& flags)
+	void lr35902::left_shift_u8(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -394,7 +421,7 @@ namespace naive_gbe
 		set_zero_flag(value, flags);
 	}
 
-	void lr35902::right_shift_u8(address& addr, std::uint8_t& flags)
+	void lr35902::right_shift_u8(address addr, std::uint8_t& flags)
 	{
 		std::uint8_t value = addr;
 
@@ -599,7 +626,7 @@ namespace naive_gbe
 		ops[0x7c] = operation{ 1,  4, std::bind(&lr35902::op_ld_r8_r8, this, get_ref(r8::A), get_ref(r8::H)) };
 		ops[0x7d] = operation{ 1,  4, std::bind(&lr35902::op_ld_r8_r8, this, get_ref(r8::A), get_ref(r8::L)) };
 		ops[0x7e] = operation{ 1,  8, std::bind(&lr35902::op_ld_r8_hl, this, get_ref(r8::A)) };
-		ops[0x7f] = operation{ 1,  4, std::bind(&lr35902::op_ld_r8_r8, this, get_ref(r8::A), get_ref(r8::B)) };
+		ops[0x7f] = operation{ 1,  4, std::bind(&lr35902::op_ld_r8_r8, this, get_ref(r8::A), get_ref(r8::A)) };
 
 		ops[0x80] = operation{ 1,  4, std::bind(&lr35902::op_add_r8, this, get_ref(r8::A), get_ref(r8::B), get_ref(r8::F)) };
 		ops[0x81] = operation{ 1,  4, std::bind(&lr35902::op_add_r8, this, get_ref(r8::A), get_ref(r8::C), get_ref(r8::F)) };
@@ -1882,7 +1909,7 @@ namespace naive_gbe
 	// Z 0 0 C
 	void lr35902::op_sra_hl(std::uint8_t& flags)
 	{
-		address& hl_ref = get_hl_ref();
+		address hl_ref = get_hl_ref();
 		std::uint8_t value = hl_ref;
 		std::uint8_t bit7 = value & bits::B7;
 
@@ -1956,7 +1983,7 @@ namespace naive_gbe
 	// - - - -
 	void lr35902::op_res_hl(std::uint8_t bit)
 	{
-		address& addr = get_hl_ref();
+		address addr = get_hl_ref();
 		addr = addr & ~bit;
 	}
 
@@ -1973,7 +2000,7 @@ namespace naive_gbe
 	// - - - -
 	void lr35902::op_set_hl(std::uint8_t bit)
 	{
-		address& addr = get_hl_ref();
+		address addr = get_hl_ref();
 		addr = addr | bit;
 	}
 }
@@ -5,15 +5,27 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 //
 #include <naive_gbe/emulator.hpp>
+#include <naive_gbe/hash.hpp>
+
+#include <algorithm>
 
 namespace naive_gbe
 {
 	emulator::emulator()
 		: ppu_{ mmu_ }
+		, apu_{ mmu_ }
 		, cpu_{ mmu_, ppu_ }
 		, disasm_{ mmu_ }
 		, state_{ state::NO_CARTRIDGE }
 	{
+		mmu_.set_io_handler(IO_REG_P1, &emulator::write_joypad, this);
+		update_joypad();
+
+		buffer bootstrap(0x100);
+		for (std::uint16_t addr = 0; addr < bootstrap.size(); ++addr)
+			bootstrap[addr] = static_cast<mmu const&>(mmu_)[addr];
+
+		boot_hash_ = hash64(bootstrap.data(), bootstrap.size());
 	}
 
 	emulator::state emulator::get_state() const
@@ -23,21 +35,43 @@ namespace naive_gbe
 
 	void emulator::reset()
 	{
+		movie_mode_ = movie_mode::OFF;
 		cpu_.reset();
 		mmu_.reset();
+		ppu_.reset();
+		apu_.reset();
+		update_joypad();
 	}
 
 	void emulator::set_cartridge(cartridge&& cartridge)
 	{
+		rom_hash_ = hash64(cartridge.get_data().data(), cartridge.get_data().size());
+		movie_mode_ = movie_mode::OFF;
+
 		mmu_.set_cartridge(std::move(cartridge));
+		mmu_.reset();
+		last_run_ = time_point{};
+		overshoot_ = 0;
+		rate_.reset();
+		meter_.reset();
 		cpu_.reset();
+		ppu_.reset();
+		apu_.reset();
+		update_joypad();
 		state_ = state::READY;
 	}
 
 	void emulator::set_bootstrap(buffer&& bootstrap)
 	{
+		boot_hash_ = hash64(bootstrap.data(), std::min<std::size_t>(bootstrap.size(), 0x100));
+		movie_mode_ = movie_mode::OFF;
+
 		mmu_.set_bootstrap(std::move(bootstrap));
+		mmu_.reset();
 		cpu_.reset();
+		ppu_.reset();
+		apu_.reset();
+		update_joypad();
 	}
 
 	bool emulator::load_rom(std::string const& rom_path, std::error_code& ec)
@@ -47,16 +81,44 @@ namespace naive_gbe
 		if (!cartridge.load(rom_path, ec))
 			return false;
 
+		bool has_battery = cartridge.has_battery();
+
 		set_cartridge(std::move(cartridge));
 
+		if (has_battery && !mmu_.load_save_ram(get_save_path(rom_path), ec))
+			return false;
+
 		return true;
 	}
 
+	std::string emulator::get_save_path(std::string const& rom_path) const
+	{
+		auto dot = rom_path.find_last_of('.');
+		auto sep = rom_path.find_last_of("\\/");
+
+		if (dot == std::string::npos || (sep != std::string::npos && dot < sep))
+			return rom_path + ".sav";
+
+		return rom_path.substr(0, dot) + ".sav";
+	}
+
+	std::string emulator::get_movie_path(std::string const& rom_path) const
+	{
+		auto save_path = get_save_path(rom_path);
+
+		return save_path.substr(0, save_path.size() - 4) + ".gbm";
+	}
+
 	lr35902& emulator::get_cpu()
 	{
 		return cpu_;
 	}
 
+	mmu& emulator::get_mmu()
+	{
+		return mmu_;
+	}
+
 	mmu const& emulator::get_mmu() const
 	{
 		return mmu_;
@@ -67,6 +129,83 @@ namespace naive_gbe
 		return ppu_;
 	}
 
+	apu const& emulator::get_apu() const
+	{
+		return apu_;
+	}
+
+	frame_exchange& emulator::get_frames()
+	{
+		return ppu_.get_frames();
+	}
+
+	audio_ring& emulator::get_audio()
+	{
+		return apu_.get_samples();
+	}
+
+	void emulator::set_sample_rate(std::uint32_t sample_rate)
+	{
+		apu_.set_sample_rate(sample_rate);
+	}
+
+	void emulator::set_render_mode(ppu::render_mode mode, std::size_t interval)
+	{
+		render_mode_ = mode;
+		interval_ = interval;
+
+		if (!turbo_)
+			ppu_.set_render_mode(mode, interval);
+	}
+
+	void emulator::set_turbo(bool enabled, std::size_t interval)
+	{
+		turbo_ = enabled;
+
+		if (enabled && render_mode_ != ppu::RENDER_TIMING_ONLY)
+			ppu_.set_render_mode(ppu::RENDER_INTERVAL, interval);
+		else
+			ppu_.set_render_mode(render_mode_, interval_);
+	}
+
+	bool emulator::is_turbo() const
+	{
+		return turbo_;
+	}
+
+	void emulator::set_output(ppu::output_format format, ppu::rgba_palette const& palette)
+	{
+		ppu_.set_output(format, palette);
+		recorder_.set_palette(palette);
+	}
+
+	void emulator::set_raster_threads(std::size_t count)
+	{
+		ppu_.set_raster_threads(count);
+	}
+
+	bool emulator::start_recording(std::string const& file_name, video_recorder::format format, std::error_code& ec)
+	{
+		if (!recorder_.start(file_name, format, ec))
+			return false;
+
+		ppu_.set_frame_handler(&video_recorder::on_frame, &recorder_);
+
+		return true;
+	}
+
+	bool emulator::stop_recording(std::error_code& ec)
+	{
+		ppu_.set_frame_handler(nullptr, nullptr);
+
+		return recorder_.stop(ec);
+	}
+
+	video_recorder const& emulator::get_recorder() const
+	{
+		return recorder_;
+	}
+
 	std::size_t emulator::run()
 	{
 		if (state_ == state::NO_CARTRIDGE)
@@ -74,35 +213,231 @@ namespace naive_gbe
 
 		using namespace std::chrono;
 
-		std::size_t last_cycle = cpu_.get_cycle();
+		auto now = steady_clock::now();
+		auto const& ring = apu_.get_samples();
+		std::size_t first_cycle = cpu_.get_cycle();
 		std::size_t num_steps = 0;
 
-		if (last_cycle)
+		if (turbo_)
 		{
-			auto now = high_resolution_clock::now();
-			auto elapsed_us = duration_cast<microseconds>(now - last_run_).count();
+			auto deadline = now + microseconds{ TURBO_SLICE_US };
 
-			if (elapsed_us)
-				last_cycle += (lr35902::frequencies::NOMINAL * 1000) / elapsed_us;
+			// Whole frames between clock reads keep the timing overhead out of the stepping loop.
+			do
+				num_steps += step_until(cpu_.get_cycle() + ppu::CYCLES_PER_FRAME);
+			while (steady_clock::now() < deadline);
+
+			last_run_ = steady_clock::now();
 		}
 		else
 		{
-			++last_cycle;
+			std::uint64_t elapsed_us = 0;
+
+			if (last_run_ != time_point{})
+				elapsed_us = duration_cast<microseconds>(now - last_run_).count();
+
+			last_run_ = now;
+
+			std::size_t budget = rate_.advance(elapsed_us, ring.get_available(), ring.get_capacity());
+			std::size_t carried = std::min(overshoot_, budget);
+			std::size_t last_cycle = first_cycle + budget - carried;
+
+			num_steps = step_until(last_cycle);
+			overshoot_ = overshoot_ - carried + cpu_.get_cycle() - std::min(cpu_.get_cycle(), last_cycle);
+		}
+
+		apu_.flush();
+		mmu_.get_save_ram().update(cpu_.get_cycle());
+
+		auto end = steady_clock::now();
+		meter_.add(cpu_.get_cycle() - first_cycle, end - now, end);
+
+		return num_steps;
+	}
+
+	std::size_t emulator::step_until(std::size_t cycle)
+	{
+		std::size_t num_steps = 0;
+
+		// Movies latch input on frame boundaries, so recording and playback step whole frames.
+		if (movie_mode_ != movie_mode::OFF)
+		{
+			while (cpu_.get_cycle() < cycle)
+			{
+				std::size_t steps = run_frame();
+
+				if (!steps)
+					break;
+
+				num_steps += steps;
+			}
+
+			return num_steps;
 		}
 
-		while (cpu_.get_cycle() < last_cycle)
+		while (cpu_.get_cycle() < cycle)
 		{
 			cpu_.step();
 			++num_steps;
 		}
 
-		ppu_.write_to_video_ram();
+		return num_steps;
+	}
 
-		last_run_ = high_resolution_clock::now();
+	std::size_t emulator::run_frame()
+	{
+		latch_input();
+
+		std::size_t frame = ppu_.get_frame();
+		std::size_t limit = cpu_.get_cycle() + ppu::CYCLES_PER_FRAME;
+		std::size_t num_steps = 0;
+
+		while (ppu_.get_frame() == frame && cpu_.get_cycle() < limit && cpu_.get_state() != lr35902::state::STOPPED)
+		{
+			cpu_.step();
+			++num_steps;
+		}
 
 		return num_steps;
 	}
 
+	bool emulator::record_movie(std::error_code& ec)
+	{
+		if (state_ == state::NO_CARTRIDGE)
+		{
+			ec = std::make_error_code(std::errc::operation_not_permitted);
+			return false;
+		}
+
+		movie_.clear(get_anchor());
+		power_on();
+		movie_mode_ = movie_mode::RECORDING;
+
+		return true;
+	}
+
+	bool emulator::play_movie(movie const& movie, std::error_code& ec)
+	{
+		if (state_ == state::NO_CARTRIDGE)
+		{
+			ec = std::make_error_code(std::errc::operation_not_permitted);
+			return false;
+		}
+
+		auto anchor = get_anchor();
+
+		auto const& expected = movie.get_anchor();
+
+		if (expected.boot_hash_ != anchor.boot_hash_ || expected.rom_hash_ != anchor.rom_hash_ || expected.ram_hash_ != anchor.ram_hash_)
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		movie_ = movie;
+		cursor_ = {};
+		power_on();
+		movie_mode_ = movie_mode::PLAYING;
+
+		return true;
+	}
+
+	void emulator::stop_movie()
+	{
+		if (movie_mode_ == movie_mode::RECORDING)
+			movie_.set_result({ cpu_.get_cycle(), ppu_.get_frame_hash() });
+
+		movie_mode_ = movie_mode::OFF;
+		apply_joypad(input_);
+	}
+
+	emulator::movie_mode emulator::get_movie_mode() const
+	{
+		return movie_mode_;
+	}
+
+	movie const& emulator::get_movie() const
+	{
+		return movie_;
+	}
+
+	void emulator::power_on()
+	{
+		reset();
+		joypad_.reset();
+		update_joypad();
+		last_run_ = time_point{};
+		overshoot_ = 0;
+		rate_.reset();
+		meter_.reset();
+	}
+
+	movie::anchor emulator::get_anchor()
+	{
+		auto& ram = mmu_.get_save_ram();
+		movie::anchor anchor;
+
+		anchor.boot_hash_ = boot_hash_;
+		anchor.rom_hash_ = rom_hash_;
+		anchor.ram_hash_ = ram.is_mapped() ? hash64(ram.get_data(), ram.get_size()) : 0;
+
+		return anchor;
+	}
+
+	void emulator::latch_input()
+	{
+		std::uint8_t input = 0;
+
+		switch (movie_mode_)
+		{
+		case movie_mode::OFF:
+			break;
+		case movie_mode::RECORDING:
+			apply_joypad(input_);
+			movie_.append(static_cast<std::uint8_t>(joypad_.to_ulong()));
+			break;
+		case movie_mode::PLAYING:
+			if (movie_.next(cursor_, input))
+				apply_joypad(joypad_state{ input });
+			else
+				stop_movie();
+			break;
+		}
+	}
+
+	void emulator::apply_joypad(joypad_state const& state)
+	{
+		if (joypad_ == state)
+			return;
+
+		joypad_ = state;
+		update_joypad();
+	}
+
+	double emulator::get_speed() const
+	{
+		return rate_.get_speed();
+	}
+
+	std::chrono::microseconds emulator::get_audio_lead() const
+	{
+		auto const& ring = apu_.get_samples();
+		auto fill = static_cast<std::int64_t>(ring.get_available());
+		auto target = static_cast<std::int64_t>(ring.get_capacity() / 2);
+
+		return std::chrono::microseconds{ (fill - target) * 1000000 / apu_.get_sample_rate() };
+	}
+
+	std::chrono::nanoseconds emulator::get_frame_time() const
+	{
+		return meter_.get_frame_time();
+	}
+
+	double emulator::get_throughput() const
+	{
+		return meter_.get_speed();
+	}
+
 	std::string emulator::disassembly()
 	{
 		std::uint16_t addr = cpu_.get_register(lr35902::r16::PC);
@@ -112,11 +447,51 @@ namespace naive_gbe
 
 	void emulator::set_joypad(joypad_input input, bool value)
 	{
-		joypad_.set(static_cast<std::size_t>(input), value);
+		input_.set(static_cast<std::size_t>(input), value);
+
+		if (movie_mode_ == movie_mode::OFF)
+			apply_joypad(input_);
 	}
 
 	emulator::joypad_state const& emulator::get_joypad() const
 	{
 		return joypad_;
 	}
+
+	void emulator::write_joypad(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		static_cast<emulator*>(context)->update_joypad();
+	}
+
+	void emulator::update_joypad()
+	{
+		auto pressed = [this](joypad_input input, std::uint8_t bit)
+		{
+			return joypad_.test(static_cast<std::size_t>(input)) ? bit : 0;
+		};
+
+		std::uint8_t select = mmu_.get_io(IO_REG_P1) & 0x30;
+		std::uint8_t lines = 0;
+
+		if (!(select & 0x10))
+		{
+			lines |= pressed(joypad_input::RIGHT, 0x01) | pressed(joypad_input::LEFT, 0x02) |
+				pressed(joypad_input::UP, 0x04) | pressed(joypad_input::DOWN, 0x08);
+		}
+
+		if (!(select & 0x20))
+		{
+			lines |= pressed(joypad_input::A, 0x01) | pressed(joypad_input::B, 0x02) |
+				pressed(joypad_input::SELECT, 0x04) | pressed(joypad_input::START, 0x08);
+		}
+
+		lines = ~lines & 0x0f;
+
+		// A line going low raises the interrupt, whether from a key press or a select change.
+		if (joypad_lines_ & ~lines)
+			mmu_.request_interrupt(mmu::INT_JOYPAD);
+
+		joypad_lines_ = lines;
+		mmu_.set_io(IO_REG_P1, 0xc0 | select | lines);
+	}
 }
@@ -0,0 +1,287 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/emulator_thread.hpp>
+
+#include <algorithm>
+
+namespace naive_gbe
+{
+	std::uint16_t emulator_thread::status::get_register(lr35902::r16 reg) const
+	{
+		return registers_[static_cast<std::size_t>(reg) / 2];
+	}
+
+	emulator_thread::emulator_thread(emulator& emulator)
+		: emulator_(emulator)
+		, running_{ false }
+		, head_{ 0 }
+		, tail_{ 0 }
+		, middle_{ 1 }
+	{
+	}
+
+	emulator_thread::~emulator_thread()
+	{
+		stop();
+	}
+
+	emulator& emulator_thread::get_emulator()
+	{
+		return emulator_;
+	}
+
+	void emulator_thread::start()
+	{
+		if (thread_.joinable())
+			return;
+
+		running_.store(true, std::memory_order_release);
+		thread_ = std::thread{ &emulator_thread::work, this };
+	}
+
+	void emulator_thread::stop()
+	{
+		if (!thread_.joinable())
+			return;
+
+		running_.store(false, std::memory_order_release);
+		thread_.join();
+	}
+
+	bool emulator_thread::is_running() const
+	{
+		return running_.load(std::memory_order_acquire);
+	}
+
+	bool emulator_thread::post(command&& cmd)
+	{
+		std::size_t head = head_.load(std::memory_order_relaxed);
+
+		if (head - tail_.load(std::memory_order_acquire) == QUEUE_SIZE)
+			return false;
+
+		commands_[head % QUEUE_SIZE] = std::move(cmd);
+		head_.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	bool emulator_thread::set_joypad(joypad_input input, bool pressed)
+	{
+		return post(command{ command_type::JOYPAD, input, pressed });
+	}
+
+	bool emulator_thread::pause()
+	{
+		return post(command{ command_type::PAUSE });
+	}
+
+	bool emulator_thread::resume()
+	{
+		return post(command{ command_type::RESUME });
+	}
+
+	bool emulator_thread::reset()
+	{
+		return post(command{ command_type::RESET });
+	}
+
+	bool emulator_thread::load_rom(std::string const& rom_path)
+	{
+		command cmd;
+		cmd.type_ = command_type::LOAD_ROM;
+		cmd.path_ = rom_path;
+
+		return post(std::move(cmd));
+	}
+
+	bool emulator_thread::set_turbo(bool enabled)
+	{
+		return post(command{ command_type::TURBO, joypad_input::START, enabled });
+	}
+
+	bool emulator_thread::record_movie()
+	{
+		return post(command{ command_type::RECORD_MOVIE });
+	}
+
+	bool emulator_thread::stop_movie(std::string const& file_name)
+	{
+		command cmd;
+		cmd.type_ = command_type::STOP_MOVIE;
+		cmd.path_ = file_name;
+
+		return post(std::move(cmd));
+	}
+
+	bool emulator_thread::play_movie(std::string const& file_name)
+	{
+		command cmd;
+		cmd.type_ = command_type::PLAY_MOVIE;
+		cmd.path_ = file_name;
+
+		return post(std::move(cmd));
+	}
+
+	bool emulator_thread::acquire_status()
+	{
+		if (!(middle_.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+
+		return true;
+	}
+
+	emulator_thread::status const& emulator_thread::get_status() const
+	{
+		return status_[front_];
+	}
+
+	void emulator_thread::work()
+	{
+		command cmd;
+
+		while (running_.load(std::memory_order_acquire))
+		{
+			while (pop(cmd))
+				execute(cmd);
+
+			if (!paused_)
+				steps_ += emulator_.run();
+
+			publish();
+
+			std::this_thread::sleep_for(get_sleep());
+		}
+	}
+
+	bool emulator_thread::pop(command& cmd)
+	{
+		std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+		if (tail == head_.load(std::memory_order_acquire))
+			return false;
+
+		cmd = std::move(commands_[tail % QUEUE_SIZE]);
+		tail_.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	void emulator_thread::execute(command& cmd)
+	{
+		switch (cmd.type_)
+		{
+		case command_type::JOYPAD:
+			emulator_.set_joypad(cmd.input_, cmd.value_);
+			break;
+		case command_type::PAUSE:
+			paused_ = true;
+			break;
+		case command_type::RESUME:
+			paused_ = false;
+			break;
+		case command_type::RESET:
+			emulator_.reset();
+			steps_ = 0;
+			break;
+		case command_type::LOAD_ROM:
+			error_.clear();
+			emulator_.load_rom(cmd.path_, error_);
+			steps_ = 0;
+			++loads_;
+			break;
+		case command_type::TURBO:
+			emulator_.set_turbo(cmd.value_);
+			break;
+		case command_type::RECORD_MOVIE:
+			movie_error_.clear();
+			emulator_.record_movie(movie_error_);
+			steps_ = 0;
+			break;
+		case command_type::STOP_MOVIE:
+			movie_error_.clear();
+			emulator_.stop_movie();
+
+			if (!cmd.path_.empty())
+				emulator_.get_movie().save(cmd.path_, movie_error_);
+			break;
+		case command_type::PLAY_MOVIE:
+		{
+			movie movie;
+
+			movie_error_.clear();
+
+			if (movie.load(cmd.path_, movie_error_))
+				emulator_.play_movie(movie, movie_error_);
+
+			steps_ = 0;
+			break;
+		}
+		}
+	}
+
+	void emulator_thread::publish()
+	{
+		auto& status = status_[back_];
+		auto& cpu = emulator_.get_cpu();
+		auto const& mmu = emulator_.get_mmu();
+		auto const& ppu = emulator_.get_ppu();
+
+		for (auto reg : { lr35902::r16::AF, lr35902::r16::BC, lr35902::r16::DE,
+			lr35902::r16::HL, lr35902::r16::SP, lr35902::r16::PC })
+			status.registers_[static_cast<std::size_t>(reg) / 2] = cpu.get_register(reg);
+
+		// Disassembling allocates, and the next opcode only means something while paused.
+		if (paused_)
+			status.next_op_ = emulator_.disassembly();
+		else
+			status.next_op_.clear();
+
+		status.error_ = error_;
+		status.movie_error_ = movie_error_;
+		status.movie_frames_ = emulator_.get_movie().get_num_frames();
+		status.loads_ = loads_;
+		status.steps_ = steps_;
+		status.cycle_ = cpu.get_cycle();
+		status.frame_ = ppu.get_frame();
+		status.skipped_ = ppu.get_lines_skipped();
+		status.speed_ = emulator_.get_speed();
+		status.throughput_ = emulator_.get_throughput();
+		status.frame_time_ = emulator_.get_frame_time();
+		status.audio_lead_ = emulator_.get_audio_lead();
+		status.state_ = emulator_.get_state();
+		status.movie_mode_ = emulator_.get_movie_mode();
+		status.cpu_state_ = cpu.get_state();
+		status.joypad_ = emulator_.get_joypad();
+		status.flags_ = cpu.get_flags();
+		status.ime_ = cpu.get_ime();
+		status.lcdc_ = mmu.get_io(ppu::IO_REG_LCDC);
+		status.scy_ = mmu.get_io(ppu::IO_REG_SCY);
+		status.ly_ = mmu.get_io(ppu::IO_REG_LY);
+		status.paused_ = paused_;
+		status.turbo_ = emulator_.is_turbo();
+
+		back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	std::chrono::microseconds emulator_thread::get_sleep() const
+	{
+		using std::chrono::microseconds;
+
+		if (paused_ || emulator_.get_state() == emulator::state::NO_CARTRIDGE)
+			return microseconds{ IDLE_SLEEP_US };
+
+		if (emulator_.is_turbo())
+			return microseconds{ 0 };
+
+		auto lead = emulator_.get_audio_lead();
+
+		return std::clamp(lead, microseconds{ MIN_SLEEP_US }, microseconds{ MAX_SLEEP_US });
+	}
+}
@@ -0,0 +1,47 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/frame_exchange.hpp>
+
+namespace naive_gbe
+{
+	frame_exchange::frame_exchange()
+		: middle_(1)
+		, published_(0)
+	{
+	}
+
+	frame_exchange::frame& frame_exchange::get_back()
+	{
+		return frames_[back_];
+	}
+
+	void frame_exchange::publish()
+	{
+		back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+		published_.fetch_add(1, std::memory_order_release);
+	}
+
+	bool frame_exchange::acquire()
+	{
+		if (!(middle_.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+
+		return true;
+	}
+
+	frame_exchange::frame const& frame_exchange::get_front() const
+	{
+		return frames_[front_];
+	}
+
+	std::size_t frame_exchange::get_published() const
+	{
+		return published_.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,105 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/hash.hpp>
+
+#include <cstring>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		constexpr std::uint64_t PRIME_1 = 0x9e3779b185ebca87ull;
+		constexpr std::uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4full;
+		constexpr std::uint64_t PRIME_3 = 0x165667b19e3779f9ull;
+		constexpr std::uint64_t PRIME_4 = 0x85ebca77c2b2ae63ull;
+		constexpr std::uint64_t PRIME_5 = 0x27d4eb2f165667c5ull;
+
+		std::uint64_t rotate(std::uint64_t value, int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		std::uint64_t load64(std::uint8_t const* data)
+		{
+			std::uint64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		std::uint32_t load32(std::uint8_t const* data)
+		{
+			std::uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		std::uint64_t round(std::uint64_t acc, std::uint64_t input)
+		{
+			return rotate(acc + input * PRIME_2, 31) * PRIME_1;
+		}
+
+		std::uint64_t merge(std::uint64_t acc, std::uint64_t value)
+		{
+			return (acc ^ round(0, value)) * PRIME_1 + PRIME_4;
+		}
+	}
+
+	std::uint64_t hash64(void const* data, std::size_t size, std::uint64_t seed)
+	{
+		auto p = static_cast<std::uint8_t const*>(data);
+		auto end = p + size;
+		std::uint64_t hash;
+
+		if (size >= 32)
+		{
+			std::uint64_t v1 = seed + PRIME_1 + PRIME_2;
+			std::uint64_t v2 = seed + PRIME_2;
+			std::uint64_t v3 = seed;
+			std::uint64_t v4 = seed - PRIME_1;
+
+			for (; p + 32 <= end; p += 32)
+			{
+				v1 = round(v1, load64(p));
+				v2 = round(v2, load64(p + 8));
+				v3 = round(v3, load64(p + 16));
+				v4 = round(v4, load64(p + 24));
+			}
+
+			hash = rotate(v1, 1) + rotate(v2, 7) + rotate(v3, 12) + rotate(v4, 18);
+			hash = merge(hash, v1);
+			hash = merge(hash, v2);
+			hash = merge(hash, v3);
+			hash = merge(hash, v4);
+		}
+		else
+		{
+			hash = seed + PRIME_5;
+		}
+
+		hash += size;
+
+		for (; p + 8 <= end; p += 8)
+			hash = rotate(hash ^ round(0, load64(p)), 27) * PRIME_1 + PRIME_4;
+
+		if (p + 4 <= end)
+		{
+			hash = rotate(hash ^ (load32(p) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+			p += 4;
+		}
+
+		for (; p < end; ++p)
+			hash = rotate(hash ^ (*p * PRIME_5), 11) * PRIME_1;
+
+		hash ^= hash >> 33;
+		hash *= PRIME_2;
+		hash ^= hash >> 29;
+		hash *= PRIME_3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+}
@@ -0,0 +1,194 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/headless_runner.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace naive_gbe
+{
+	headless_runner::headless_runner(emulator& emulator)
+		: emulator_(emulator)
+	{
+	}
+
+	headless_runner::frame_hashes headless_runner::run(std::size_t num_frames, input_script const& script)
+	{
+		input_script events = script;
+		std::stable_sort(events.begin(), events.end(),
+			[](input_event const& lhs, input_event const& rhs) { return lhs.frame_ < rhs.frame_; });
+
+		frame_hashes hashes;
+		hashes.reserve(num_frames);
+
+		auto next = events.begin();
+
+		for (std::size_t frame = 0; frame < num_frames; ++frame)
+		{
+			for (; next != events.end() && next->frame_ <= frame; ++next)
+				emulator_.set_joypad(next->input_, next->pressed_);
+
+			run_frame();
+			hashes.push_back(emulator_.get_ppu().get_frame_hash());
+		}
+
+		return hashes;
+	}
+
+	bool headless_runner::play(movie const& movie, frame_hashes& hashes, std::error_code& ec)
+	{
+		if (!emulator_.play_movie(movie, ec))
+			return false;
+
+		hashes.clear();
+		hashes.reserve(movie.get_num_frames());
+
+		for (std::uint64_t frame = 0; frame < movie.get_num_frames(); ++frame)
+		{
+			run_frame();
+			hashes.push_back(emulator_.get_ppu().get_frame_hash());
+		}
+
+		emulator_.stop_movie();
+
+		auto const& result = movie.get_result();
+		std::uint64_t frame_hash = emulator_.get_ppu().get_frame_hash();
+
+		if (result.cycle_ && (result.cycle_ != emulator_.get_cpu().get_cycle() || result.frame_hash_ != frame_hash))
+		{
+			ec = std::make_error_code(std::errc::state_not_recoverable);
+			return false;
+		}
+
+		return true;
+	}
+
+	void headless_runner::run_frame()
+	{
+		emulator_.run_frame();
+	}
+
+	bool headless_runner::load_script(std::string const& file_name, input_script& script, std::error_code& ec)
+	{
+		std::ifstream ifs(file_name);
+
+		if (!ifs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		std::ostringstream oss;
+		oss << ifs.rdbuf();
+
+		return parse_script(oss.str(), script, ec);
+	}
+
+	bool headless_runner::parse_script(std::string const& text, input_script& script, std::error_code& ec)
+	{
+		static std::unordered_map<std::string, emulator::joypad_input> const inputs =
+		{
+			{ "SELECT",	emulator::joypad_input::SELECT },
+			{ "START",	emulator::joypad_input::START },
+			{ "A",		emulator::joypad_input::A },
+			{ "B",		emulator::joypad_input::B },
+			{ "UP",		emulator::joypad_input::UP },
+			{ "DOWN",	emulator::joypad_input::DOWN },
+			{ "LEFT",	emulator::joypad_input::LEFT },
+			{ "RIGHT",	emulator::joypad_input::RIGHT },
+		};
+
+		std::istringstream iss(text);
+		std::string line;
+		input_script result;
+
+		while (std::getline(iss, line))
+		{
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream fields(line);
+			input_event event;
+			std::string input;
+			std::string action;
+
+			if (!(fields >> event.frame_))
+			{
+				if (line.find_first_not_of(" \t\r") == std::string::npos)
+					continue;
+
+				ec = std::make_error_code(std::errc::invalid_argument);
+				return false;
+			}
+
+			if (!(fields >> input >> action) || !inputs.count(input) || (action != "down" && action != "up"))
+			{
+				ec = std::make_error_code(std::errc::invalid_argument);
+				return false;
+			}
+
+			event.input_ = inputs.at(input);
+			event.pressed_ = action == "down";
+			result.push_back(event);
+		}
+
+		script = std::move(result);
+
+		return true;
+	}
+
+	bool headless_runner::load_hashes(std::string const& file_name, frame_hashes& hashes, std::error_code& ec)
+	{
+		std::ifstream ifs(file_name);
+
+		if (!ifs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		frame_hashes result;
+		std::uint64_t hash;
+
+		while (ifs >> std::hex >> hash)
+			result.push_back(hash);
+
+		if (!ifs.eof())
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		hashes = std::move(result);
+
+		return true;
+	}
+
+	bool headless_runner::save_hashes(std::string const& file_name, frame_hashes const& hashes, std::error_code& ec)
+	{
+		std::ofstream ofs(file_name);
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		for (auto hash : hashes)
+			ofs << std::hex << std::setw(16) << std::setfill('0') << hash << '\n';
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		return true;
+	}
+}
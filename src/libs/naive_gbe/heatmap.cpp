@@ -0,0 +1,175 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/heatmap.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <fstream>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		const char HEATMAP_MAGIC[4] = { 'G', 'B', 'H', 'M' };
+
+		const std::uint32_t HEATMAP_VERSION = 1;
+
+		std::uint8_t scale(heatmap::counter value, heatmap::counter max)
+		{
+			if (!max)
+				return 0;
+
+			return static_cast<std::uint8_t>(255.0 * std::log1p(value) / std::log1p(max));
+		}
+	}
+
+	heatmap::heatmap()
+		: space_(ADDRESS_SPACE)
+	{
+		rom_pages_.fill(-1);
+	}
+
+	void heatmap::clear()
+	{
+		std::fill(space_.begin(), space_.end(), counters{});
+		std::fill(rom_.begin(), rom_.end(), counters{});
+	}
+
+	void heatmap::set_rom_size(std::size_t size)
+	{
+		rom_.assign((size + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE * ROM_BANK_SIZE, counters{});
+		rom_pages_.fill(-1);
+	}
+
+	void heatmap::map_rom_page(std::size_t index, std::int64_t offset)
+	{
+		if (offset >= 0 && static_cast<std::size_t>(offset) + PAGE_SIZE > rom_.size())
+			offset = -1;
+
+		rom_pages_[index] = offset;
+	}
+
+	heatmap::counter heatmap::get(std::uint16_t addr, access kind) const
+	{
+		return space_[addr][kind];
+	}
+
+	heatmap::counter heatmap::get_rom(std::size_t offset, access kind) const
+	{
+		return offset < rom_.size() ? rom_[offset][kind] : 0;
+	}
+
+	std::size_t heatmap::get_num_rom_banks() const
+	{
+		return rom_.size() / ROM_BANK_SIZE;
+	}
+
+	bool heatmap::save(std::string const& file_name, std::error_code& ec) const
+	{
+		std::ofstream ofs(file_name, std::ios::binary);
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		std::uint32_t header[] =
+		{
+			HEATMAP_VERSION,
+			NUM_ACCESSES,
+			static_cast<std::uint32_t>(space_.size()),
+			static_cast<std::uint32_t>(rom_.size()),
+		};
+
+		ofs.write(HEATMAP_MAGIC, sizeof(HEATMAP_MAGIC));
+		ofs.write(reinterpret_cast<char const*>(header), sizeof(header));
+		ofs.write(reinterpret_cast<char const*>(space_.data()), space_.size() * sizeof(counters));
+		ofs.write(reinterpret_cast<char const*>(rom_.data()), rom_.size() * sizeof(counters));
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		return true;
+	}
+
+	bool heatmap::save_ppm(std::string const& file_name, std::size_t granularity, std::error_code& ec) const
+	{
+		return write_ppm(file_name, space_.data(), space_.size(), granularity, ec);
+	}
+
+	bool heatmap::save_rom_bank_ppm(std::string const& file_name, std::size_t bank, std::size_t granularity, std::error_code& ec) const
+	{
+		if (bank >= get_num_rom_banks())
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		return write_ppm(file_name, rom_.data() + bank * ROM_BANK_SIZE, ROM_BANK_SIZE, granularity, ec);
+	}
+
+	bool heatmap::write_ppm(std::string const& file_name, counters const* data, std::size_t size,
+		std::size_t granularity, std::error_code& ec) const
+	{
+		if (!granularity || PAGE_SIZE % granularity)
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		std::size_t cells = size / granularity;
+		std::vector<counters> merged(cells);
+		counters max{};
+
+		for (std::size_t cell = 0; cell < cells; ++cell)
+		{
+			for (std::size_t offset = 0; offset < granularity; ++offset)
+			{
+				for (std::size_t kind = 0; kind < NUM_ACCESSES; ++kind)
+					merged[cell][kind] += data[cell * granularity + offset][kind];
+			}
+
+			for (std::size_t kind = 0; kind < NUM_ACCESSES; ++kind)
+				max[kind] = std::max(max[kind], merged[cell][kind]);
+		}
+
+		std::ofstream ofs(file_name, std::ios::binary);
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		ofs << "P6\n" << PAGE_SIZE / granularity << " " << size / PAGE_SIZE << "\n255\n";
+
+		std::vector<std::uint8_t> pixels;
+		pixels.reserve(cells * 3);
+
+		for (auto const& cell : merged)
+		{
+			pixels.push_back(scale(cell[WRITE], max[WRITE]));
+			pixels.push_back(scale(cell[READ], max[READ]));
+			pixels.push_back(scale(cell[EXECUTE], max[EXECUTE]));
+		}
+
+		ofs.write(reinterpret_cast<char const*>(pixels.data()), pixels.size());
+
+		if (!ofs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -7,37 +7,38 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
-#include <functional>
 
 namespace naive_gbe
 {
+	class mmu;
+
 	class address
 	{
 	public:
 
-		using callback_type = std::function<void(std::uint8_t&)>;
-
 		enum class access_mode : std::uint8_t
 		{
 			READ_ONLY,
 			READ_WRITE
 		};
 
-		address(std::uint8_t* data, access_mode mode = access_mode::READ_ONLY);
-
-		void set(std::uint8_t* data, access_mode mode);
+		address(mmu& mmu, std::uint16_t addr)
+			: mmu_(mmu)
+			, addr_(addr)
+		{
+		}
 
-		void set(callback_type callback);
+		address(address const&) = default;
 
 		operator std::uint8_t() const;
 
 		void operator=(std::uint8_t value);
 
+		void operator=(address const& rhs);
+
 	private:
 
-		std::uint8_t*	data_		= nullptr;
-		callback_type	callback_	= nullptr;
-		access_mode		mode_		= access_mode::READ_ONLY;
+		mmu&			mmu_;
+		std::uint16_t	addr_;
 	};
 }
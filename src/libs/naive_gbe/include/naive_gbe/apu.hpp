@@ -0,0 +1,198 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <naive_gbe/mmu.hpp>
+#include <naive_gbe/blip_buffer.hpp>
+#include <naive_gbe/audio_kernels.hpp>
+#include <naive_gbe/audio_ring.hpp>
+
+namespace naive_gbe
+{
+	class apu
+	{
+	public:
+
+		enum constants : std::uint32_t
+		{
+			CYCLES_PER_SECOND		= 4194304,
+			CYCLES_PER_STEP			= CYCLES_PER_SECOND / 512,
+			DEFAULT_SAMPLE_RATE		= 48000,
+			WAVE_SAMPLES			= 32,
+			VOLUME_UNIT				= 64,
+		};
+
+		enum channel_id : std::uint8_t
+		{
+			CHANNEL_SQUARE1,
+			CHANNEL_SQUARE2,
+			CHANNEL_WAVE,
+			CHANNEL_NOISE,
+			NUM_CHANNELS
+		};
+
+		enum io_register : std::uint16_t
+		{
+			IO_REG_NR10				= 0xff10,
+			IO_REG_NR11				= 0xff11,
+			IO_REG_NR12				= 0xff12,
+			IO_REG_NR13				= 0xff13,
+			IO_REG_NR14				= 0xff14,
+			IO_REG_NR21				= 0xff16,
+			IO_REG_NR22				= 0xff17,
+			IO_REG_NR23				= 0xff18,
+			IO_REG_NR24				= 0xff19,
+			IO_REG_NR30				= 0xff1a,
+			IO_REG_NR31				= 0xff1b,
+			IO_REG_NR32				= 0xff1c,
+			IO_REG_NR33				= 0xff1d,
+			IO_REG_NR34				= 0xff1e,
+			IO_REG_NR41				= 0xff20,
+			IO_REG_NR42				= 0xff21,
+			IO_REG_NR43				= 0xff22,
+			IO_REG_NR44				= 0xff23,
+			IO_REG_NR50				= 0xff24,
+			IO_REG_NR51				= 0xff25,
+			IO_REG_NR52				= 0xff26,
+			IO_REG_WAVE_FIRST		= 0xff30,
+			IO_REG_WAVE_LAST		= 0xff3f,
+		};
+
+		apu(mmu& mmu);
+
+		void reset();
+
+		void set_sample_rate(std::uint32_t sample_rate);
+
+		std::uint32_t get_sample_rate() const;
+
+		audio_ring& get_samples();
+
+		audio_ring const& get_samples() const;
+
+		bool is_enabled() const;
+
+		bool is_channel_on(channel_id id) const;
+
+		void set_isa(audio_kernels::isa isa);
+
+		audio_kernels::isa get_isa() const;
+
+		void flush();
+
+	private:
+
+		struct channel
+		{
+			std::uint64_t	next_			= 0;
+			std::uint32_t	period_			= 0;
+			std::uint16_t	frequency_		= 0;
+			std::uint16_t	length_			= 0;
+			bool			length_enabled_	= false;
+			bool			enabled_		= false;
+			bool			dac_			= false;
+			std::uint8_t	volume_			= 0;
+			std::uint8_t	envelope_		= 0;
+			std::uint8_t	env_timer_		= 0;
+			std::uint8_t	duty_			= 0;
+			std::uint8_t	position_		= 0;
+			std::int32_t	amplitude_		= 0;
+		};
+
+		using channels		= std::array<channel, NUM_CHANNELS>;
+
+		using buffers		= std::array<blip_buffer, NUM_CHANNELS>;
+
+		using wave_table	= std::array<std::uint8_t, WAVE_SAMPLES>;
+
+		using sample_buffer	= std::vector<std::int16_t>;
+
+		using channel_buffers	= std::array<sample_buffer, NUM_CHANNELS>;
+
+		using mix_gains		= audio_kernels::mix_gains;
+
+		static void on_event(void* context, std::uint64_t cycle);
+
+		static void write_register(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_wave(void* context, std::uint16_t addr, std::uint8_t value);
+
+		void power(bool on);
+
+		void run(std::uint64_t cycle);
+
+		void run_square(channel& ch, std::uint64_t cycle);
+
+		void run_wave(std::uint64_t cycle);
+
+		void run_noise(std::uint64_t cycle);
+
+		void step_sequencer();
+
+		void clock_length(channel& ch);
+
+		void clock_envelope(channel& ch);
+
+		void clock_sweep();
+
+		std::uint16_t compute_sweep();
+
+		void trigger(channel_id id);
+
+		void write_length(channel_id id, std::uint8_t value);
+
+		void write_envelope(channel_id id, std::uint8_t value);
+
+		void write_frequency(channel_id id, std::uint8_t low, std::uint8_t high);
+
+		void update_period(channel_id id);
+
+		void update_gains();
+
+		bool is_audible(std::size_t index) const;
+
+		void update_status();
+
+		void set_level(channel& ch, std::size_t index, std::uint64_t cycle, std::uint8_t level);
+
+		void refresh(channel_id id);
+
+		std::uint8_t get_level(channel_id id) const;
+
+		std::uint32_t get_time(std::uint64_t cycle) const;
+
+		void end_frame(std::uint64_t cycle);
+
+		mmu&			mmu_;
+		buffers			buffers_;
+		audio_kernels	kernels_;
+		audio_ring		ring_;
+		channel_buffers	channel_samples_;
+		sample_buffer	samples_;
+		std::uint32_t	sample_rate_	= DEFAULT_SAMPLE_RATE;
+		channels		channels_;
+		mix_gains		gains_			= {};
+		wave_table		wave_			= {};
+		std::uint64_t	frame_start_	= 0;
+		std::uint64_t	cycle_			= 0;
+		bool			enabled_		= false;
+		std::uint8_t	sequencer_		= 0;
+		std::uint8_t	sweep_period_	= 0;
+		std::uint8_t	sweep_timer_	= 0;
+		std::uint8_t	sweep_shift_	= 0;
+		bool			sweep_negate_	= false;
+		bool			sweep_enabled_	= false;
+		std::uint16_t	shadow_			= 0;
+		std::uint8_t	wave_shift_		= 4;
+		std::uint16_t	lfsr_			= 0x7fff;
+		bool			narrow_			= false;
+	};
+}
@@ -0,0 +1,55 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include <naive_gbe/pixel_kernels.hpp>
+
+namespace naive_gbe
+{
+	class audio_kernels
+	{
+	public:
+
+		using isa = pixel_kernels::isa;
+
+		enum constants : std::size_t
+		{
+			NUM_CHANNELS	= 4,
+			MIX_SHIFT		= 3,
+		};
+
+		using channel_samples	= std::array<std::int16_t const*, NUM_CHANNELS>;
+
+		using mix_gains			= std::array<std::int16_t, NUM_CHANNELS * 2>;
+
+		audio_kernels();
+
+		audio_kernels(isa isa);
+
+		isa get_isa() const;
+
+		static bool is_supported(isa isa);
+
+		void mix(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out) const;
+
+	private:
+
+		using mix_kernel	= void (*)(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out);
+
+		isa				isa_		= isa::SCALAR;
+		mix_kernel		mix_		= nullptr;
+	};
+
+	inline void audio_kernels::mix(channel_samples const& channels, std::size_t count, mix_gains const& gains, std::int16_t* out) const
+	{
+		mix_(channels, count, gains, out);
+	}
+}
@@ -0,0 +1,52 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace naive_gbe
+{
+	class audio_ring
+	{
+	public:
+
+		enum constants : std::size_t
+		{
+			NUM_CHANNELS		= 2,
+			DEFAULT_CAPACITY	= 1 << 12,
+		};
+
+		audio_ring(std::size_t capacity = DEFAULT_CAPACITY);
+
+		audio_ring(audio_ring const&) = delete;
+
+		audio_ring& operator=(audio_ring const&) = delete;
+
+		std::size_t get_capacity() const;
+
+		std::size_t get_available() const;
+
+		std::size_t write(std::int16_t const* samples, std::size_t frames);
+
+		std::size_t read(std::int16_t* samples, std::size_t frames);
+
+		std::size_t get_overruns() const;
+
+		std::size_t get_underruns() const;
+
+	private:
+
+		std::vector<std::int16_t>	samples_;
+		std::size_t					mask_		= 0;
+		std::atomic<std::size_t>	head_;
+		std::atomic<std::size_t>	tail_;
+		std::atomic<std::size_t>	overruns_;
+		std::atomic<std::size_t>	underruns_;
+	};
+}
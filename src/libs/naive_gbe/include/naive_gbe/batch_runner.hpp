@@ -0,0 +1,69 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <system_error>
+
+#include <naive_gbe/worker_pool.hpp>
+
+namespace naive_gbe
+{
+	class batch_runner
+	{
+	public:
+
+		struct job
+		{
+			std::string					rom_path_;
+			std::string					movie_path_;
+			std::size_t					frames_		= 0;
+		};
+
+		struct result
+		{
+			std::size_t					index_		= 0;
+			std::size_t					frames_		= 0;
+			std::uint64_t				frame_hash_	= 0;
+			std::uint64_t				cycles_		= 0;
+			std::chrono::nanoseconds	wall_time_	= {};
+			bool						checked_	= false;
+			bool						desync_		= false;
+			std::error_code				error_;
+		};
+
+		using job_list		= std::vector<job>;
+
+		using result_list	= std::vector<result>;
+
+		using result_handler	= std::function<void(job const& job, result const& result)>;
+
+		batch_runner(std::size_t num_threads = get_default_threads());
+
+		std::size_t get_num_threads() const;
+
+		result_list run(job_list const& jobs, result_handler const& on_result = {});
+
+		static result run_job(job const& job);
+
+		static std::size_t get_default_threads();
+
+		static bool load_manifest(std::string const& file_name, job_list& jobs, std::error_code& ec);
+
+		static bool parse_manifest(std::string const& text, std::string const& base_dir, job_list& jobs, std::error_code& ec);
+
+		static std::string to_json(job const& job, result const& result);
+
+	private:
+
+		worker_pool		pool_;
+	};
+}
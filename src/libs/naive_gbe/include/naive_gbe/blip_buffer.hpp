@@ -0,0 +1,56 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace naive_gbe
+{
+	class blip_buffer
+	{
+	public:
+
+		enum constants : std::uint32_t
+		{
+			PHASE_BITS			= 5,
+			NUM_PHASES			= 1 << PHASE_BITS,
+			NUM_TAPS			= 16,
+			KERNEL_BITS			= 12,
+			FRAC_BITS			= 32,
+			BASS_SHIFT			= 9,
+			DEFAULT_CAPACITY	= 4096,
+		};
+
+		blip_buffer(std::size_t capacity = DEFAULT_CAPACITY);
+
+		void set_rates(std::uint32_t clock_rate, std::uint32_t sample_rate);
+
+		void clear();
+
+		void add_delta(std::uint32_t time, std::int32_t delta);
+
+		void end_frame(std::uint32_t time);
+
+		std::size_t get_available() const;
+
+		std::size_t read(std::int16_t* out, std::size_t count, std::size_t stride);
+
+	private:
+
+		using kernel = std::array<std::array<std::int32_t, NUM_TAPS>, NUM_PHASES>;
+
+		static kernel const& get_kernel();
+
+		std::vector<std::int32_t>	buffer_;
+		std::size_t					capacity_	= 0;
+		std::uint64_t				factor_		= 0;
+		std::uint64_t				offset_		= 0;
+		std::int64_t				integral_	= 0;
+	};
+}
@@ -15,6 +15,13 @@ namespace naive_gbe
 	{
 	public:
 
+		enum header : std::uint16_t
+		{
+			HEADER_TYPE				= 0x0147,
+			HEADER_ROM_SIZE			= 0x0148,
+			HEADER_RAM_SIZE			= 0x0149,
+		};
+
 		cartridge() = default;
 
 		cartridge(buffer&& data);
@@ -25,6 +32,12 @@ namespace naive_gbe
 
 		buffer& get_data();
 
+		std::uint8_t get_type() const;
+
+		bool has_battery() const;
+
+		std::size_t get_ram_size() const;
+
 	protected:
 
 		buffer	data_;
@@ -72,6 +72,8 @@ namespace naive_gbe
 			handler			func_	= nullptr;
 		};
 
+		using register_file	= std::array<std::uint8_t, 12>;
+
 		lr35902(mmu& mmu, ppu& ppu);
 
 		state get_state() const;
@@ -92,6 +94,12 @@ namespace naive_gbe
 
 		std::uint16_t get_register(r16 index) const;
 
+		register_file const& get_registers() const;
+
+		void set_registers(register_file const& registers, std::size_t cycle);
+
+		std::uint8_t get_cycles(std::uint8_t opcode) const;
+
 	private:
 
 		struct daa
@@ -100,12 +108,14 @@ namespace naive_gbe
 			bool			carry_	= false;
 		};
 
-		using registers		= std::array<std::uint8_t, 12>;
+		using registers		= register_file;
 		using daas			= std::vector<daa>;
 		using operations	= std::vector<operation>;
 
 		void step(operations& ops, bool extended);
 
+		std::uint8_t fetch_opcode();
+
 		std::uint8_t fetch_u8();
 
 		std::int8_t fetch_i8();
@@ -120,7 +130,7 @@ namespace naive_gbe
 
 		auto get_ref(r8 reg);
 
-		address& get_hl_ref();
+		address get_hl_ref();
 
 		std::uint8_t swap_nibbles(std::uint8_t value) const;
 
@@ -144,41 +154,41 @@ namespace naive_gbe
 
 		void compare(std::uint8_t lhs, std::uint8_t rhs, std::uint8_t& flags);
 
-		void left_rotate(address& addr, std::uint8_t& flags);
+		void left_rotate(address addr, std::uint8_t& flags);
 
 		void left_rotate(std::uint8_t& value, std::uint8_t& flags);
 
-		void left_rotate_carry(address& addr, std::uint8_t& flags);
+		void left_rotate_carry(address addr, std::uint8_t& flags);
 
 		void left_rotate_carry(std::uint8_t& value, std::uint8_t& flags);
 
-		void increment(address& addr, std::uint8_t& flags);
+		void increment(address addr, std::uint8_t& flags);
 
 		void increment(std::uint8_t& value, std::uint8_t& flags);
 
-		void decrement(address& addr, std::uint8_t& flags);
+		void decrement(address addr, std::uint8_t& flags);
 
 		void decrement(std::uint8_t& value, std::uint8_t& flags);
 
-		void add(address& lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags);
+		void add(address lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags);
 
 		void add(std::uint8_t& lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags);
 
 		void sub(std::uint8_t& lhs, std::uint8_t rhs, std::uint8_t carry, std::uint8_t& flags);
 
-		void right_rotate(address& addr, std::uint8_t& flags);
+		void right_rotate(address addr, std::uint8_t& flags);
 
 		void right_rotate(std::uint8_t& value, std::uint8_t& flags);
 
-		void right_rotate_carry(address& addr, std::uint8_t& flags);
+		void right_rotate_carry(address addr, std::uint8_t& flags);
 
 		void right_rotate_carry(std::uint8_t& value, std::uint8_t& flags);
 
-		void left_shift_u8(address& addr, std::uint8_t& flags);
+		void left_shift_u8(address addr, std::uint8_t& flags);
 
 		void left_shift_u8(std::uint8_t& value, std::uint8_t& flags);
 
-		void right_shift_u8(address& value, std::uint8_t& flags);
+		void right_shift_u8(address value, std::uint8_t& flags);
 
 		void right_shift_u8(std::uint8_t& value, std::uint8_t& flags);
 
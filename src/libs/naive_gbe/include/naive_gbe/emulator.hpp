@@ -15,6 +15,11 @@
 #include <naive_gbe/mmu.hpp>
 #include <naive_gbe/cpu.hpp>
 #include <naive_gbe/ppu.hpp>
+#include <naive_gbe/apu.hpp>
+#include <naive_gbe/video_recorder.hpp>
+#include <naive_gbe/rate_control.hpp>
+#include <naive_gbe/speed_meter.hpp>
+#include <naive_gbe/movie.hpp>
 #include <naive_gbe/cartridge.hpp>
 #include <naive_gbe/disassembler.hpp>
 
@@ -34,6 +39,24 @@ namespace naive_gbe
 			PAUSED
 		};
 
+		enum io_register : std::uint16_t
+		{
+			IO_REG_P1		= 0xff00,
+		};
+
+		enum constants : std::uint32_t
+		{
+			TURBO_SLICE_US			= 16000,
+			DEFAULT_TURBO_INTERVAL	= 8,
+		};
+
+		enum class movie_mode : std::uint8_t
+		{
+			OFF,
+			RECORDING,
+			PLAYING
+		};
+
 		enum class joypad_input : std::uint8_t
 		{
 			SELECT,
@@ -58,14 +81,64 @@ namespace naive_gbe
 
 		bool load_rom(std::string const& rom_path, std::error_code& ec);
 
+		std::string get_save_path(std::string const& rom_path) const;
+
 		lr35902& get_cpu();
 
+		mmu& get_mmu();
+
 		mmu const& get_mmu() const;
 
 		ppu const& get_ppu() const;
 
+		apu const& get_apu() const;
+
+		frame_exchange& get_frames();
+
+		audio_ring& get_audio();
+
+		void set_sample_rate(std::uint32_t sample_rate);
+
+		void set_render_mode(ppu::render_mode mode, std::size_t interval = 1);
+
+		void set_turbo(bool enabled, std::size_t interval = DEFAULT_TURBO_INTERVAL);
+
+		bool is_turbo() const;
+
+		void set_output(ppu::output_format format, ppu::rgba_palette const& palette);
+
+		void set_raster_threads(std::size_t count);
+
+		bool start_recording(std::string const& file_name, video_recorder::format format, std::error_code& ec);
+
+		bool stop_recording(std::error_code& ec);
+
+		video_recorder const& get_recorder() const;
+
 		std::size_t run();
 
+		std::size_t run_frame();
+
+		bool record_movie(std::error_code& ec);
+
+		bool play_movie(movie const& movie, std::error_code& ec);
+
+		void stop_movie();
+
+		movie_mode get_movie_mode() const;
+
+		movie const& get_movie() const;
+
+		std::string get_movie_path(std::string const& rom_path) const;
+
+		double get_speed() const;
+
+		std::chrono::microseconds get_audio_lead() const;
+
+		std::chrono::nanoseconds get_frame_time() const;
+
+		double get_throughput() const;
+
 		std::string disassembly();
 
 		void set_joypad(joypad_input input, bool value);
@@ -74,16 +147,44 @@ namespace naive_gbe
 
 	private:
 
-		using time_point	= std::chrono::high_resolution_clock::time_point;
+		using time_point	= std::chrono::steady_clock::time_point;
+
+		static void write_joypad(void* context, std::uint16_t addr, std::uint8_t value);
+
+		std::size_t step_until(std::size_t cycle);
+
+		void power_on();
+
+		movie::anchor get_anchor();
+
+		void latch_input();
+
+		void apply_joypad(joypad_state const& state);
 
+		void update_joypad();
 
 		state			state_		= state::NO_CARTRIDGE;
 		time_point		last_run_;
+		rate_control	rate_;
+		speed_meter		meter_;
+		bool			turbo_		= false;
+		ppu::render_mode	render_mode_	= ppu::RENDER_FULL;
+		std::size_t		interval_	= 1;
+		std::size_t		overshoot_	= 0;
+		std::uint64_t	boot_hash_	= 0;
+		std::uint64_t	rom_hash_	= 0;
+		movie			movie_;
+		movie::cursor	cursor_;
+		movie_mode		movie_mode_	= movie_mode::OFF;
 		mmu				mmu_;
 		ppu				ppu_;
+		apu				apu_;
 		lr35902			cpu_;
 		disassembler	disasm_;
+		video_recorder	recorder_;
 		joypad_state	joypad_;
+		joypad_state	input_;
+		std::uint8_t	joypad_lines_	= 0x0f;
 	};
 
 }
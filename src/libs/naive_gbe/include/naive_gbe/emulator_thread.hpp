@@ -0,0 +1,168 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <naive_gbe/emulator.hpp>
+
+namespace naive_gbe
+{
+	class emulator_thread
+	{
+	public:
+
+		using joypad_input	= emulator::joypad_input;
+
+		using joypad_state	= emulator::joypad_state;
+
+		enum constants : std::uint32_t
+		{
+			QUEUE_SIZE			= 64,
+			MIN_SLEEP_US		= 1000,
+			MAX_SLEEP_US		= 8000,
+			IDLE_SLEEP_US		= 10000,
+		};
+
+		enum class command_type : std::uint8_t
+		{
+			JOYPAD,
+			PAUSE,
+			RESUME,
+			RESET,
+			LOAD_ROM,
+			TURBO,
+			RECORD_MOVIE,
+			STOP_MOVIE,
+			PLAY_MOVIE,
+		};
+
+		struct command
+		{
+			command_type	type_		= command_type::PAUSE;
+			joypad_input	input_		= joypad_input::START;
+			bool			value_		= false;
+			std::string		path_		= {};
+		};
+
+		struct status
+		{
+			std::array<std::uint16_t, 6>	registers_	= {};
+			std::string						next_op_;
+			std::error_code					error_;
+			std::error_code					movie_error_;
+			std::uint64_t					movie_frames_	= 0;
+			std::size_t						loads_		= 0;
+			std::size_t						steps_		= 0;
+			std::size_t						cycle_		= 0;
+			std::size_t						frame_		= 0;
+			std::size_t						skipped_	= 0;
+			double							speed_		= 1.0;
+			double							throughput_	= 0.0;
+			std::chrono::nanoseconds		frame_time_	= {};
+			std::chrono::microseconds		audio_lead_	= {};
+			emulator::state					state_		= emulator::state::NO_CARTRIDGE;
+			emulator::movie_mode			movie_mode_	= emulator::movie_mode::OFF;
+			lr35902::state					cpu_state_	= lr35902::state::READY;
+			joypad_state					joypad_;
+			std::uint8_t					flags_		= 0;
+			std::uint8_t					ime_		= 0;
+			std::uint8_t					lcdc_		= 0;
+			std::uint8_t					scy_		= 0;
+			std::uint8_t					ly_			= 0;
+			bool							paused_		= false;
+			bool							turbo_		= false;
+
+			std::uint16_t get_register(lr35902::r16 reg) const;
+		};
+
+		emulator_thread(emulator& emulator);
+
+		emulator_thread(emulator_thread const&) = delete;
+
+		emulator_thread& operator=(emulator_thread const&) = delete;
+
+		~emulator_thread();
+
+		emulator& get_emulator();
+
+		void start();
+
+		void stop();
+
+		bool is_running() const;
+
+		bool post(command&& cmd);
+
+		bool set_joypad(joypad_input input, bool pressed);
+
+		bool pause();
+
+		bool resume();
+
+		bool reset();
+
+		bool load_rom(std::string const& rom_path);
+
+		bool set_turbo(bool enabled);
+
+		bool record_movie();
+
+		bool stop_movie(std::string const& file_name);
+
+		bool play_movie(std::string const& file_name);
+
+		bool acquire_status();
+
+		status const& get_status() const;
+
+	private:
+
+		enum status_index : std::uint8_t
+		{
+			NUM_STATUS		= 3,
+			INDEX_MASK		= 0x03,
+			FRESH			= 0x04,
+		};
+
+		using command_queue	= std::array<command, QUEUE_SIZE>;
+
+		using status_slots	= std::array<status, NUM_STATUS>;
+
+		void work();
+
+		bool pop(command& cmd);
+
+		void execute(command& cmd);
+
+		void publish();
+
+		std::chrono::microseconds get_sleep() const;
+
+		emulator&					emulator_;
+		std::thread					thread_;
+		std::atomic<bool>			running_;
+		command_queue				commands_;
+		std::atomic<std::size_t>	head_;
+		std::atomic<std::size_t>	tail_;
+		status_slots				status_;
+		std::atomic<std::uint8_t>	middle_;
+		std::uint8_t				back_		= 0;
+		std::uint8_t				front_		= 2;
+		std::error_code				error_;
+		std::error_code				movie_error_;
+		std::size_t					loads_		= 0;
+		std::size_t					steps_		= 0;
+		bool						paused_		= false;
+	};
+}
@@ -0,0 +1,54 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace naive_gbe
+{
+	class frame_exchange
+	{
+	public:
+
+		struct frame
+		{
+			std::vector<std::uint8_t>	shades_;
+			std::vector<std::uint32_t>	rgba_;
+			std::size_t					number_		= 0;
+		};
+
+		frame_exchange();
+
+		frame& get_back();
+
+		void publish();
+
+		bool acquire();
+
+		frame const& get_front() const;
+
+		std::size_t get_published() const;
+
+	private:
+
+		enum constants : std::uint8_t
+		{
+			NUM_FRAMES		= 3,
+			INDEX_MASK		= 0x03,
+			FRESH			= 0x04,
+		};
+
+		std::array<frame, NUM_FRAMES>	frames_;
+		std::atomic<std::uint8_t>		middle_;
+		std::atomic<std::size_t>		published_;
+		std::uint8_t					back_		= 0;
+		std::uint8_t					front_		= 2;
+	};
+}
@@ -0,0 +1,15 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace naive_gbe
+{
+	std::uint64_t hash64(void const* data, std::size_t size, std::uint64_t seed = 0);
+}
@@ -0,0 +1,53 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <system_error>
+
+#include <naive_gbe/emulator.hpp>
+
+namespace naive_gbe
+{
+	class headless_runner
+	{
+	public:
+
+		struct input_event
+		{
+			std::size_t					frame_		= 0;
+			emulator::joypad_input		input_		= emulator::joypad_input::START;
+			bool						pressed_	= true;
+		};
+
+		using input_script	= std::vector<input_event>;
+
+		using frame_hashes	= std::vector<std::uint64_t>;
+
+		headless_runner(emulator& emulator);
+
+		frame_hashes run(std::size_t num_frames, input_script const& script = {});
+
+		bool play(movie const& movie, frame_hashes& hashes, std::error_code& ec);
+
+		void run_frame();
+
+		static bool load_script(std::string const& file_name, input_script& script, std::error_code& ec);
+
+		static bool parse_script(std::string const& text, input_script& script, std::error_code& ec);
+
+		static bool load_hashes(std::string const& file_name, frame_hashes& hashes, std::error_code& ec);
+
+		static bool save_hashes(std::string const& file_name, frame_hashes const& hashes, std::error_code& ec);
+
+	private:
+
+		emulator&	emulator_;
+	};
+}
@@ -0,0 +1,90 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <system_error>
+
+#ifndef NAIVE_GBE_HEATMAP
+	#define NAIVE_GBE_HEATMAP 0
+#endif
+
+namespace naive_gbe
+{
+	class heatmap
+	{
+	public:
+
+		enum access : std::uint8_t
+		{
+			READ,
+			WRITE,
+			EXECUTE,
+			NUM_ACCESSES
+		};
+
+		enum constants : std::size_t
+		{
+			ADDRESS_SPACE			= 0x10000,
+			PAGE_SIZE				= 0x100,
+			ROM_PAGES				= 0x80,
+			ROM_BANK_SIZE			= 0x4000,
+			LINE_SIZE				= 16,
+		};
+
+		using counter	= std::uint32_t;
+
+		using counters	= std::array<counter, NUM_ACCESSES>;
+
+		heatmap();
+
+		void clear();
+
+		void set_rom_size(std::size_t size);
+
+		void map_rom_page(std::size_t index, std::int64_t offset);
+
+		void count(std::uint16_t addr, access kind);
+
+		counter get(std::uint16_t addr, access kind) const;
+
+		counter get_rom(std::size_t offset, access kind) const;
+
+		std::size_t get_num_rom_banks() const;
+
+		bool save(std::string const& file_name, std::error_code& ec) const;
+
+		bool save_ppm(std::string const& file_name, std::size_t granularity, std::error_code& ec) const;
+
+		bool save_rom_bank_ppm(std::string const& file_name, std::size_t bank, std::size_t granularity, std::error_code& ec) const;
+
+	private:
+
+		bool write_ppm(std::string const& file_name, counters const* data, std::size_t size,
+			std::size_t granularity, std::error_code& ec) const;
+
+		std::vector<counters>				space_;
+		std::vector<counters>				rom_;
+		std::array<std::int64_t, ROM_PAGES>	rom_pages_;
+	};
+
+	inline void heatmap::count(std::uint16_t addr, access kind)
+	{
+		++space_[addr][kind];
+
+		if (addr < ROM_PAGES * PAGE_SIZE)
+		{
+			std::int64_t offset = rom_pages_[addr / PAGE_SIZE];
+
+			if (offset >= 0)
+				++rom_[offset + addr % PAGE_SIZE][kind];
+		}
+	}
+}
@@ -0,0 +1,154 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <naive_gbe/emulator.hpp>
+#include <naive_gbe/pixel_kernels.hpp>
+
+namespace naive_gbe
+{
+	class lockstep_cpu
+	{
+	public:
+
+		using isa = pixel_kernels::isa;
+
+		using r8 = lr35902::r8;
+
+		using r16 = lr35902::r16;
+
+		enum constants : std::size_t
+		{
+			VECTOR_LANES		= 16,
+			BLOCK_LANES			= 64,
+			NUM_R8				= 8,
+		};
+
+		enum class alu_op : std::uint8_t
+		{
+			ADD,
+			ADC,
+			SUB,
+			SBC,
+			AND,
+			XOR,
+			OR,
+			CP,
+		};
+
+		struct statistics
+		{
+			std::uint64_t	groups_			= 0;
+			std::uint64_t	vector_steps_	= 0;
+			std::uint64_t	scalar_steps_	= 0;
+		};
+
+		lockstep_cpu(std::size_t num_lanes, buffer const& rom, isa isa = isa::SSE2);
+
+		isa get_isa() const;
+
+		static bool is_supported(isa isa);
+
+		std::size_t get_num_lanes() const;
+
+		emulator& get_emulator(std::size_t lane);
+
+		void run_frame();
+
+		std::uint8_t get_register(std::size_t lane, r8 reg) const;
+
+		std::uint16_t get_register(std::size_t lane, r16 reg) const;
+
+		std::size_t get_cycle(std::size_t lane) const;
+
+		statistics const& get_statistics() const;
+
+	private:
+
+		enum class op_kind : std::uint8_t
+		{
+			SCALAR,
+			NOP,
+			MOVE,
+			MOVE_D8,
+			INC,
+			DEC,
+			ALU,
+			ALU_D8,
+			JR,
+			JR_COND,
+		};
+
+		struct decoded_op
+		{
+			op_kind			kind_		= op_kind::SCALAR;
+			alu_op			alu_		= alu_op::ADD;
+			std::uint8_t	dst_		= 0;
+			std::uint8_t	src_		= 0;
+			std::uint8_t	size_		= 1;
+			std::uint8_t	cycles_		= 4;
+			std::uint8_t	flag_		= 0;
+			bool			state_		= false;
+		};
+
+		using lanes			= std::vector<std::unique_ptr<emulator>>;
+
+		using lane_u8		= std::vector<std::uint8_t>;
+
+		using lane_u16		= std::vector<std::uint16_t>;
+
+		using lane_u64		= std::vector<std::uint64_t>;
+
+		using register_lanes	= std::array<lane_u8, NUM_R8>;
+
+		using decode_table	= std::array<decoded_op, 0x100>;
+
+		using alu_kernel	= void (*)(alu_op op, std::uint8_t* a, std::uint8_t const* rhs, std::uint8_t* f, std::uint8_t const* mask, std::size_t count);
+
+		using inc_dec_kernel	= void (*)(bool decrement, std::uint8_t* reg, std::uint8_t* f, std::uint8_t const* mask, std::size_t count);
+
+		using move_kernel	= void (*)(std::uint8_t* dst, std::uint8_t const* src, std::uint8_t const* mask, std::size_t count);
+
+		using match_kernel	= std::uint64_t (*)(std::uint16_t const* pc, std::uint16_t value, std::size_t count);
+
+		void set_decode_table();
+
+		void load_registers(std::size_t lane);
+
+		void store_registers(std::size_t lane);
+
+		void run_block(std::size_t first, std::size_t last);
+
+		std::uint64_t run_group(std::size_t first, std::size_t count, std::uint64_t pending, std::uint64_t& running);
+
+		bool step_scalar(std::size_t lane);
+
+		bool is_running(std::size_t lane);
+
+		isa				isa_			= isa::SCALAR;
+		alu_kernel		alu_			= nullptr;
+		inc_dec_kernel	inc_dec_		= nullptr;
+		move_kernel		move_			= nullptr;
+		match_kernel	match_			= nullptr;
+		lanes			lanes_;
+		decode_table	decoded_;
+		register_lanes	regs_;
+		lane_u16		sp_;
+		lane_u16		pc_;
+		lane_u64		cycle_;
+		lane_u64		limit_;
+		lane_u64		frame_;
+		lane_u8			imm_;
+		lane_u8			group_;
+		statistics		statistics_;
+	};
+}
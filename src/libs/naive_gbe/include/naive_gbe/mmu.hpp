@@ -8,10 +8,14 @@
 
 #include <cstdint>
 #include <vector>
+#include <array>
 #include <functional>
 
 #include <naive_gbe/cartridge.hpp>
 #include <naive_gbe/address.hpp>
+#include <naive_gbe/heatmap.hpp>
+#include <naive_gbe/save_ram.hpp>
+#include <naive_gbe/scheduler.hpp>
 #include <naive_gbe/types.hpp>
 
 namespace naive_gbe
@@ -20,34 +24,292 @@ namespace naive_gbe
 	{
 	public:
 
+		using read_handler	= std::uint8_t (*)(void* context, std::uint16_t addr);
+
+		using write_handler	= void (*)(void* context, std::uint16_t addr, std::uint8_t value);
+
+		using sync_handler	= void (*)(void* context, std::uint16_t addr);
+
+		enum constants : std::size_t
+		{
+			PAGE_SHIFT				= 8,
+			PAGE_SIZE				= 1 << PAGE_SHIFT,
+			NUM_PAGES				= 0x10000 >> PAGE_SHIFT,
+			OAM_SIZE				= 0xa0,
+			VIDEO_RAM_SIZE			= 0x2000,
+			DMA_CYCLES				= OAM_SIZE * 4,
+		};
+
+		struct page
+		{
+			std::uint8_t*	read_		= nullptr;
+			std::uint8_t*	write_		= nullptr;
+			read_handler	on_read_	= nullptr;
+			write_handler	on_write_	= nullptr;
+			void*			context_	= nullptr;
+		};
+
+		using page_table	= std::array<page, NUM_PAGES>;
+
+		enum io_register : std::uint16_t
+		{
+			IO_REG_IF				= 0xff0f,
+			IO_REG_LCD_FIRST		= 0xff40,
+			IO_REG_LCD_LAST			= 0xff4b,
+			IO_REG_IE				= 0xffff,
+		};
+
+		enum interrupt : std::uint8_t
+		{
+			INT_VBLANK				= 1 << 0,
+			INT_LCD_STAT			= 1 << 1,
+			INT_TIMER				= 1 << 2,
+			INT_SERIAL				= 1 << 3,
+			INT_JOYPAD				= 1 << 4,
+		};
+
+		enum watch_mode : std::uint8_t
+		{
+			WATCH_READ				= 1 << 0,
+			WATCH_WRITE				= 1 << 1,
+			WATCH_READ_WRITE		= WATCH_READ | WATCH_WRITE,
+		};
+
+		struct watch_event
+		{
+			std::uint16_t	addr_		= 0;
+			std::uint8_t	value_		= 0;
+			std::uint16_t	pc_			= 0;
+			std::uint64_t	cycle_		= 0;
+			watch_mode		access_		= WATCH_READ;
+		};
+
+		using watch_callback	= std::function<void(watch_event const&)>;
+
+		using pc_source			= std::function<std::uint16_t()>;
+
 		mmu();
 
-		address& operator[](std::uint16_t addr);
+		mmu(mmu const&) = delete;
 
-		address const& operator[](std::uint16_t addr) const;
+		mmu& operator=(mmu const&) = delete;
+
+		virtual ~mmu() = default;
+
+		address operator[](std::uint16_t addr);
+
+		std::uint8_t operator[](std::uint16_t addr) const;
+
+		std::uint8_t read(std::uint16_t addr) const;
+
+		std::uint8_t fetch(std::uint16_t addr) const;
+
+		void write(std::uint16_t addr, std::uint8_t value);
 
 		void set_bootstrap(buffer&& bootstrap);
 
 		void set_cartridge(cartridge&& cartridge);
 
+		bool load_save_ram(std::string const& file_name, std::error_code& ec);
+
+		save_ram& get_save_ram();
+
+		void set_io_handler(std::uint16_t addr, write_handler handler, void* context);
+
+		void set_video_ram_handler(write_handler handler, void* context);
+
+		void set_oam_handler(write_handler handler, void* context);
+
+		void set_sync_handler(sync_handler handler, void* context);
+
+		std::uint8_t get_io(std::uint16_t addr) const;
+
+		void set_io(std::uint16_t addr, std::uint8_t value);
+
+		void request_interrupt(interrupt mask);
+
+		std::uint8_t const* get_video_ram() const;
+
+		std::uint8_t const* get_oam() const;
+
+		scheduler& get_scheduler();
+
+		bool is_dma_active() const;
+
+		void set_pc_source(pc_source source);
+
+		std::size_t add_watchpoint(std::uint16_t first, std::uint16_t last, watch_mode mode, watch_callback callback);
+
+		void remove_watchpoint(std::size_t id);
+
+		void clear_watchpoints();
+
+#if NAIVE_GBE_HEATMAP
+		heatmap& get_heatmap();
+
+		heatmap const& get_heatmap() const;
+#endif
+
 		virtual void reset();
 
 	protected:
 
-		void disable_bootstrap(std::uint8_t value);
+		struct io_handler
+		{
+			write_handler	on_write_	= nullptr;
+			void*			context_	= nullptr;
+		};
+
+		using io_handlers	= std::array<io_handler, PAGE_SIZE>;
+
+		struct watchpoint
+		{
+			std::size_t		id_			= 0;
+			std::uint16_t	first_		= 0;
+			std::uint16_t	last_		= 0;
+			watch_mode		mode_		= WATCH_READ_WRITE;
+			watch_callback	callback_	= nullptr;
+		};
+
+		using watchpoints	= std::vector<watchpoint>;
+
+		static std::uint8_t read_open_bus(void* context, std::uint16_t addr);
+
+		static std::uint8_t read_io(void* context, std::uint16_t addr);
+
+		static void write_io(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_external_ram(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_video_ram(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_oam(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_bootstrap(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_dma(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void end_dma(void* context, std::uint64_t cycle);
+
+		static std::uint8_t read_watched(void* context, std::uint16_t addr);
+
+		static void write_watched(void* context, std::uint16_t addr, std::uint8_t value);
+
+		page& get_page(std::size_t index);
+
+		page& get_origin(std::size_t index);
+
+		void set_page(std::size_t index, page const& page);
+
+		void update_watched_pages();
+
+		void update_heatmap_page(std::size_t index, page const& origin);
+
+		void notify(std::uint16_t addr, std::uint8_t value, watch_mode access);
+
+		void sync(std::uint16_t addr) const;
+
+		void disable_bootstrap();
+
+		void start_dma(std::uint8_t source);
 
 		void assign(std::uint16_t addr, std::size_t size, std::uint8_t* data, address::access_mode mode);
 
+		void assign(std::uint16_t addr, std::size_t size, read_handler on_read, write_handler on_write, void* context);
+
+		void commit(std::uint16_t addr, std::size_t size);
+
+		void map_cartridge();
+
+		void map_external_ram();
+
 		buffer get_bootstrap() const;
 
+		std::uint8_t load(std::uint16_t addr) const;
+
 		cartridge						cartridge_;
 
 		buffer							bootstrap_;
 
 		buffer							video_ram_;
 
-		buffer							invalid_;
+		buffer							work_ram_;
+
+		buffer							high_ram_;
+
+		save_ram						external_ram_;
+
+		page_table						layout_;
+
+		page_table						pages_;
+
+		page_table						dma_pages_;
 
-		std::vector<address>			memory_;
+		bool							dma_active_		= false;
+
+		page_table						watched_pages_;
+
+		std::array<std::uint8_t, NUM_PAGES>	watched_	= {};
+
+		watchpoints						watchpoints_;
+
+		std::size_t						next_watch_id_	= 0;
+
+		pc_source						pc_source_		= nullptr;
+
+		io_handlers						io_handlers_;
+
+		io_handler						video_ram_handler_;
+
+		io_handler						oam_handler_;
+
+		sync_handler					sync_			= nullptr;
+
+		void*							sync_context_	= nullptr;
+
+		scheduler						scheduler_;
+
+#if NAIVE_GBE_HEATMAP
+		mutable heatmap					heatmap_;
+#endif
 	};
+
+	inline std::uint8_t mmu::load(std::uint16_t addr) const
+	{
+		page const& p = pages_[addr >> PAGE_SHIFT];
+
+		if (p.read_)
+			return p.read_[addr & (PAGE_SIZE - 1)];
+
+		return p.on_read_(p.context_, addr);
+	}
+
+	inline std::uint8_t mmu::read(std::uint16_t addr) const
+	{
+#if NAIVE_GBE_HEATMAP
+		heatmap_.count(addr, heatmap::READ);
+#endif
+		return load(addr);
+	}
+
+	inline std::uint8_t mmu::fetch(std::uint16_t addr) const
+	{
+#if NAIVE_GBE_HEATMAP
+		heatmap_.count(addr, heatmap::EXECUTE);
+#endif
+		return load(addr);
+	}
+
+	inline void mmu::write(std::uint16_t addr, std::uint8_t value)
+	{
+#if NAIVE_GBE_HEATMAP
+		heatmap_.count(addr, heatmap::WRITE);
+#endif
+		page const& p = pages_[addr >> PAGE_SHIFT];
+
+		if (p.write_)
+			p.write_[addr & (PAGE_SIZE - 1)] = value;
+		else if (p.on_write_)
+			p.on_write_(p.context_, addr, value);
+	}
 }
@@ -0,0 +1,86 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <system_error>
+
+namespace naive_gbe
+{
+	class movie
+	{
+	public:
+
+		enum constants : std::uint32_t
+		{
+			MAGIC			= 0x4d42474e,
+			VERSION			= 1,
+		};
+
+		enum anchor_type : std::uint16_t
+		{
+			ANCHOR_POWER_ON	= 0,
+		};
+
+		struct anchor
+		{
+			anchor_type		type_		= ANCHOR_POWER_ON;
+			std::uint64_t	boot_hash_	= 0;
+			std::uint64_t	rom_hash_	= 0;
+			std::uint64_t	ram_hash_	= 0;
+		};
+
+		struct result
+		{
+			std::uint64_t	cycle_		= 0;
+			std::uint64_t	frame_hash_	= 0;
+		};
+
+		struct input_run
+		{
+			std::uint8_t	input_		= 0;
+			std::uint64_t	length_		= 0;
+		};
+
+		struct cursor
+		{
+			std::size_t		run_		= 0;
+			std::uint64_t	offset_		= 0;
+		};
+
+		using input_runs	= std::vector<input_run>;
+
+		void clear(anchor const& anchor);
+
+		anchor const& get_anchor() const;
+
+		void append(std::uint8_t input);
+
+		bool next(cursor& cursor, std::uint8_t& input) const;
+
+		std::uint64_t get_num_frames() const;
+
+		input_runs const& get_runs() const;
+
+		void set_result(result const& result);
+
+		result const& get_result() const;
+
+		bool save(std::string const& file_name, std::error_code& ec) const;
+
+		bool load(std::string const& file_name, std::error_code& ec);
+
+	private:
+
+		anchor			anchor_;
+		result			result_;
+		input_runs		runs_;
+		std::uint64_t	num_frames_		= 0;
+	};
+}
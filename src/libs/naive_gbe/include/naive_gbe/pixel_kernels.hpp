@@ -0,0 +1,70 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace naive_gbe
+{
+	class pixel_kernels
+	{
+	public:
+
+		enum class isa : std::uint8_t
+		{
+			SCALAR,
+			SSE2,
+			AVX2
+		};
+
+		using rgba_palette	= std::array<std::uint32_t, 4>;
+
+		pixel_kernels();
+
+		pixel_kernels(isa isa);
+
+		isa get_isa() const;
+
+		static bool is_supported(isa isa);
+
+		void decode(std::uint8_t const* data, std::size_t rows, std::uint8_t* out) const;
+
+		void map(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out) const;
+
+		void expand(std::uint8_t const* shades, std::size_t count, rgba_palette const& palette, std::uint32_t* out) const;
+
+	private:
+
+		using decode_kernel	= void (*)(std::uint8_t const* data, std::size_t rows, std::uint8_t* out);
+
+		using map_kernel	= void (*)(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out);
+
+		using expand_kernel	= void (*)(std::uint8_t const* shades, std::size_t count, rgba_palette const& palette, std::uint32_t* out);
+
+		isa				isa_		= isa::SCALAR;
+		decode_kernel	decode_		= nullptr;
+		map_kernel		map_		= nullptr;
+		expand_kernel	expand_		= nullptr;
+	};
+
+	inline void pixel_kernels::decode(std::uint8_t const* data, std::size_t rows, std::uint8_t* out) const
+	{
+		decode_(data, rows, out);
+	}
+
+	inline void pixel_kernels::map(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out) const
+	{
+		map_(colors, count, palette, out);
+	}
+
+	inline void pixel_kernels::expand(std::uint8_t const* shades, std::size_t count, rgba_palette const& palette, std::uint32_t* out) const
+	{
+		expand_(shades, count, palette, out);
+	}
+}
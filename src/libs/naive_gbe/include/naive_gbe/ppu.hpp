@@ -7,9 +7,14 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <memory>
 #include <cstdint>
 
 #include <naive_gbe/mmu.hpp>
+#include <naive_gbe/pixel_kernels.hpp>
+#include <naive_gbe/frame_exchange.hpp>
+#include <naive_gbe/worker_pool.hpp>
 
 namespace naive_gbe
 {
@@ -29,10 +34,49 @@ namespace naive_gbe
 
 		enum constants : std::uint32_t
 		{
+			SCREEN_WIDTH			= 160,
+			SCREEN_HEIGHT			= 144,
 			NUM_SCAN_LINES			= 154,
+			NUM_SPRITES				= 40,
+			MAX_SPRITES_PER_LINE	= 10,
+			NUM_TILES				= 384,
+			TILE_SIZE				= 16,
+			TILE_PIXELS				= 64,
 			CYCLES_PER_SECOND		= 4194304,
-			CYCLES_PER_HBLANK		= 456,
-			CYCLES_PER_VBLANK		= CYCLES_PER_HBLANK * NUM_SCAN_LINES,
+			CYCLES_PER_OAM_SCAN		= 80,
+			CYCLES_PER_TRANSFER		= 172,
+			CYCLES_PER_HBLANK		= 204,
+			CYCLES_PER_LINE			= CYCLES_PER_OAM_SCAN + CYCLES_PER_TRANSFER + CYCLES_PER_HBLANK,
+			CYCLES_PER_FRAME		= CYCLES_PER_LINE * NUM_SCAN_LINES,
+		};
+
+		enum mode : std::uint8_t
+		{
+			MODE_HBLANK				= 0,
+			MODE_VBLANK				= 1,
+			MODE_OAM_SCAN			= 2,
+			MODE_TRANSFER			= 3,
+		};
+
+		enum render_mode : std::uint8_t
+		{
+			RENDER_FULL,
+			RENDER_INTERVAL,
+			RENDER_TIMING_ONLY,
+		};
+
+		enum output_format : std::uint8_t
+		{
+			OUTPUT_SHADES,
+			OUTPUT_RGBA32,
+		};
+
+		enum sprite_attribute : std::uint8_t
+		{
+			SPRITE_PALETTE			= 1 << 4,
+			SPRITE_X_FLIP			= 1 << 5,
+			SPRITE_Y_FLIP			= 1 << 6,
+			SPRITE_BEHIND_BG		= 1 << 7,
 		};
 
 		enum class lcd_control : std::uint16_t
@@ -78,9 +122,15 @@ namespace naive_gbe
 
 		using video_ram		= std::vector<std::uint8_t>;
 
+		using rgba_buffer	= std::vector<std::uint32_t>;
+
+		using rgba_palette	= pixel_kernels::rgba_palette;
+
+		using frame_handler	= void (*)(void* context, std::uint8_t const* shades, std::size_t frame);
+
 		ppu(mmu& mmu);
 
-		void write_to_video_ram();
+		void reset();
 
 		std::uint16_t get_screen_width() const;
 
@@ -94,14 +144,193 @@ namespace naive_gbe
 
 		video_ram const& get_video_ram() const;
 
+		rgba_buffer const& get_rgba_buffer() const;
+
+		std::uint64_t get_frame_hash() const;
+
+		void set_output(output_format format, rgba_palette const& palette);
+
+		output_format get_output_format() const;
+
+		frame_exchange& get_frames();
+
+		void set_frame_handler(frame_handler handler, void* context);
+
 		void run(std::size_t cycle);
 
 		std::size_t get_cycle() const;
 
+		std::size_t get_frame() const;
+
+		mode get_mode() const;
+
+		std::uint8_t get_line() const;
+
+		std::size_t get_lines_skipped() const;
+
+		std::size_t get_version() const;
+
+		void set_render_mode(render_mode mode, std::size_t interval = 1);
+
+		render_mode get_render_mode() const;
+
+		std::size_t get_render_interval() const;
+
+		void set_raster_threads(std::size_t count);
+
+		std::size_t get_raster_threads() const;
+
 	private:
 
+		enum line_register : std::uint8_t
+		{
+			LINE_LCDC,
+			LINE_SCX,
+			LINE_SCY,
+			LINE_WX,
+			LINE_WY,
+			LINE_BGP,
+			LINE_OBP0,
+			LINE_OBP1,
+			LINE_WINDOW,
+			NUM_LINE_REGISTERS
+		};
+
+		using line_registers	= std::array<std::uint8_t, NUM_LINE_REGISTERS>;
+
+		using line_buffer	= std::array<std::uint8_t, SCREEN_WIDTH + 8>;
+
+		using tile_cache	= std::array<std::uint8_t, NUM_TILES * TILE_PIXELS>;
+
+		using tile_flags	= std::array<bool, NUM_TILES>;
+
+		using tile_stamps	= std::array<std::uint64_t, NUM_TILES>;
+
+		using map_stamps	= std::array<std::uint64_t, 64>;
+
+		using oam_stamps	= std::array<std::uint64_t, NUM_SPRITES>;
+
+		struct sprite_list
+		{
+			std::array<std::uint8_t, MAX_SPRITES_PER_LINE>	index_;
+			std::size_t										count_		= 0;
+		};
+
+		struct line_signature
+		{
+			line_registers	registers_	= {};
+			std::uint64_t	sprites_	= 0;
+			std::uint64_t	stamp_		= 0;
+			bool			valid_		= false;
+		};
+
+		using line_signatures	= std::array<line_signature, SCREEN_HEIGHT>;
+
+		struct line_state
+		{
+			line_registers	registers_	= {};
+			sprite_list		sprites_;
+			std::uint8_t	index_		= 0;
+			bool			window_		= false;
+		};
+
+		using line_states		= std::array<line_state, SCREEN_HEIGHT>;
+
+		using workers			= std::unique_ptr<worker_pool>;
+
+		using sprite_buckets	= std::array<sprite_list, SCREEN_HEIGHT>;
+
+		static void sync(void* context, std::uint16_t addr);
+
+		static void on_event(void* context, std::uint64_t cycle);
+
+		static void write_lcdc(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_stat(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_ly(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_video_ram(void* context, std::uint16_t addr, std::uint8_t value);
+
+		static void write_oam(void* context, std::uint16_t addr, std::uint8_t value);
+
+		std::uint8_t const* get_tile(std::size_t offset);
+
+		void invalidate_lines();
+
+		void enable(std::size_t cycle);
+
+		void disable();
+
+		void advance();
+
+		void schedule();
+
+		std::size_t get_frame_end() const;
+
+		void set_mode(mode mode);
+
+		void set_line(std::uint8_t line);
+
+		void build_sprite_buckets(bool tall);
+
+		sprite_list const& get_sprites(std::uint8_t lcdc);
+
+		std::uint64_t get_map_stamp(std::size_t map, std::uint8_t y, std::size_t first, std::size_t count, bool unsigned_mode) const;
+
+		std::uint64_t get_line_stamp(std::uint8_t lcdc, bool window, sprite_list const& sprites) const;
+
+		bool is_rendering() const;
+
+		void render_line();
+
+		void flush_lines();
+
+		void publish_frame();
+
+		void rasterize(line_state const& state, line_buffer& line);
+
+		void render_background(line_state const& state, line_buffer& line);
+
+		void render_window(line_state const& state, line_buffer& line);
+
+		void render_sprites(line_state const& state, line_buffer const& line, std::uint8_t* out);
+
 		mmu&			mmu_;
+		pixel_kernels	kernels_;
 		video_ram		vram_;
-		std::size_t		cycle_	= 0;
+		rgba_buffer		rgba_;
+		rgba_palette	palette_		= { 0xffffffff, 0xffaaaaaa, 0xff555555, 0xff000000 };
+		output_format	output_			= OUTPUT_SHADES;
+		frame_exchange	frames_;
+		std::size_t		published_		= static_cast<std::size_t>(-1);
+		frame_handler	on_frame_		= nullptr;
+		void*			frame_context_	= nullptr;
+		line_buffer		line_;
+		tile_cache		tiles_;
+		tile_flags		stale_;
+		tile_stamps		tile_stamps_	= {};
+		map_stamps		map_stamps_		= {};
+		oam_stamps		oam_stamps_		= {};
+		line_signatures	signatures_;
+		line_states		pending_;
+		std::size_t		num_pending_	= 0;
+		workers			workers_;
+		sprite_buckets	buckets_;
+		bool			buckets_stale_	= true;
+		bool			buckets_tall_	= false;
+		std::uint64_t	generation_		= 0;
+		std::size_t		lines_skipped_	= 0;
+		std::size_t		last_skipped_	= 0;
+		std::size_t		version_		= 0;
+		render_mode		render_mode_	= RENDER_FULL;
+		std::size_t		interval_		= 1;
+		std::size_t		cycle_			= 0;
+		std::size_t		next_			= 0;
+		std::size_t		frame_			= 0;
+		bool			enabled_		= false;
+		mode			mode_			= MODE_HBLANK;
+		std::uint8_t	line_index_		= 0;
+		std::uint8_t	window_line_	= 0;
 	};
 }
\ No newline at end of file
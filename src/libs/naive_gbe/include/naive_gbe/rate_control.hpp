@@ -0,0 +1,42 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace naive_gbe
+{
+	class rate_control
+	{
+	public:
+
+		enum constants : std::uint64_t
+		{
+			MAX_ELAPSED_US		= 100000,
+		};
+
+		static constexpr double DEFAULT_MAX_SKEW = 0.005;
+
+		rate_control(double max_skew = DEFAULT_MAX_SKEW);
+
+		void reset();
+
+		std::uint64_t advance(std::uint64_t elapsed_us, std::size_t fill, std::size_t capacity);
+
+		double get_speed() const;
+
+		double get_max_skew() const;
+
+	private:
+
+		double		max_skew_	= DEFAULT_MAX_SKEW;
+		double		speed_		= 1.0;
+		double		carry_		= 0.0;
+		std::size_t	fill_		= 0;
+	};
+}
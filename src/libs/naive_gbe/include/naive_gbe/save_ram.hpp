@@ -0,0 +1,73 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <system_error>
+
+#include <naive_gbe/types.hpp>
+
+namespace naive_gbe
+{
+	class save_ram
+	{
+	public:
+
+		enum constants : std::size_t
+		{
+			DEFAULT_FLUSH_INTERVAL	= 4194304,
+		};
+
+		save_ram() = default;
+
+		save_ram(save_ram const&) = delete;
+
+		save_ram& operator=(save_ram const&) = delete;
+
+		~save_ram();
+
+		void open(std::size_t size);
+
+		bool open(std::string const& file_name, std::size_t size, std::error_code& ec);
+
+		void close();
+
+		bool is_mapped() const;
+
+		std::uint8_t* get_data();
+
+		std::size_t get_size() const;
+
+		void mark_dirty(std::size_t offset);
+
+		std::size_t get_dirty_pages() const;
+
+		void set_flush_interval(std::size_t cycles);
+
+		std::size_t get_flush_interval() const;
+
+		void update(std::size_t cycle);
+
+		std::size_t flush();
+
+	private:
+
+		void sync_pages(std::size_t first, std::size_t count, bool wait);
+
+		std::uint8_t*		data_			= nullptr;
+		std::size_t			size_			= 0;
+		std::size_t			page_shift_		= 12;
+		std::vector<bool>	dirty_;
+		std::size_t			num_dirty_		= 0;
+		std::size_t			interval_		= DEFAULT_FLUSH_INTERVAL;
+		std::size_t			last_flush_		= 0;
+		buffer				volatile_;
+		void*				file_			= nullptr;
+	};
+}
@@ -0,0 +1,72 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <limits>
+
+namespace naive_gbe
+{
+	class scheduler
+	{
+	public:
+
+		using handler = void (*)(void* context, std::uint64_t cycle);
+
+		enum event : std::uint8_t
+		{
+			EVENT_DMA_END,
+			EVENT_PPU,
+			EVENT_APU,
+			NUM_EVENTS
+		};
+
+		static constexpr std::uint64_t NEVER = std::numeric_limits<std::uint64_t>::max();
+
+		void reset();
+
+		void schedule(event id, std::uint64_t cycle, handler handler, void* context);
+
+		void cancel(event id);
+
+		bool is_pending(event id) const;
+
+		std::uint64_t get_event_cycle(event id) const;
+
+		std::uint64_t get_next_cycle() const;
+
+		std::uint64_t get_cycle() const;
+
+		void run(std::uint64_t cycle);
+
+	private:
+
+		struct entry
+		{
+			std::uint64_t	cycle_		= NEVER;
+			handler			handler_	= nullptr;
+			void*			context_	= nullptr;
+		};
+
+		void dispatch();
+
+		void update_next();
+
+		std::array<entry, NUM_EVENTS>	events_;
+		std::uint64_t					next_		= NEVER;
+		std::uint64_t					cycle_		= 0;
+	};
+
+	inline void scheduler::run(std::uint64_t cycle)
+	{
+		cycle_ = cycle;
+
+		if (cycle >= next_)
+			dispatch();
+	}
+}
@@ -0,0 +1,49 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <naive_gbe/ppu.hpp>
+
+namespace naive_gbe
+{
+	class speed_meter
+	{
+	public:
+
+		using clock			= std::chrono::steady_clock;
+
+		using time_point	= clock::time_point;
+
+		using duration		= std::chrono::nanoseconds;
+
+		enum constants : std::uint64_t
+		{
+			WINDOW_CYCLES		= ppu::CYCLES_PER_SECOND / 4,
+			MAX_GAP_US			= 100000,
+		};
+
+		void reset();
+
+		void add(std::uint64_t cycles, duration busy, time_point now);
+
+		duration get_frame_time() const;
+
+		double get_speed() const;
+
+	private:
+
+		time_point		start_;
+		time_point		last_;
+		std::uint64_t	cycles_		= 0;
+		duration		busy_		= {};
+		duration		frame_time_	= {};
+		double			speed_		= 0.0;
+	};
+}
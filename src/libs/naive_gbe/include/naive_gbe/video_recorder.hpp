@@ -0,0 +1,100 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <system_error>
+
+#include <naive_gbe/ppu.hpp>
+
+namespace naive_gbe
+{
+	class video_recorder
+	{
+	public:
+
+		enum format : std::uint8_t
+		{
+			FORMAT_Y4M,
+			FORMAT_RGBA,
+		};
+
+		enum constants : std::size_t
+		{
+			FRAME_WIDTH			= ppu::SCREEN_WIDTH,
+			FRAME_HEIGHT		= ppu::SCREEN_HEIGHT,
+			FRAME_PIXELS		= FRAME_WIDTH * FRAME_HEIGHT,
+			DEFAULT_CAPACITY	= 64,
+			BUFFER_SIZE			= 1 << 20,
+		};
+
+		using rgba_palette	= ppu::rgba_palette;
+
+		video_recorder(std::size_t capacity = DEFAULT_CAPACITY);
+
+		video_recorder(video_recorder const&) = delete;
+
+		video_recorder& operator=(video_recorder const&) = delete;
+
+		~video_recorder();
+
+		void set_palette(rgba_palette const& palette);
+
+		bool start(std::string const& file_name, format format, std::error_code& ec);
+
+		bool stop(std::error_code& ec);
+
+		bool is_recording() const;
+
+		bool push(std::uint8_t const* shades, std::size_t frame);
+
+		std::size_t get_recorded() const;
+
+		std::size_t get_dropped() const;
+
+		static void on_frame(void* context, std::uint8_t const* shades, std::size_t frame);
+
+	private:
+
+		struct slot
+		{
+			std::vector<std::uint8_t>	shades_;
+			rgba_palette				palette_	= {};
+			std::size_t					frame_		= 0;
+		};
+
+		void write_loop();
+
+		void encode(slot const& slot);
+
+		void append(void const* data, std::size_t size);
+
+		void flush();
+
+		std::vector<slot>			slots_;
+		std::atomic<std::size_t>	head_;
+		std::atomic<std::size_t>	tail_;
+		std::atomic<std::size_t>	dropped_;
+		std::atomic<bool>			stop_;
+		std::thread					writer_;
+		std::ofstream				ofs_;
+		std::ofstream				index_;
+		std::vector<char>			buffer_;
+		std::vector<std::uint32_t>	pixels_;
+		pixel_kernels				kernels_;
+		std::uint64_t				offset_		= 0;
+		std::error_code				error_;
+		rgba_palette				palette_	= { 0xffffffff, 0xffaaaaaa, 0xff555555, 0xff000000 };
+		format						format_		= FORMAT_Y4M;
+		bool						recording_	= false;
+	};
+}
@@ -0,0 +1,54 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace naive_gbe
+{
+	class worker_pool
+	{
+	public:
+
+		using task = std::function<void(std::size_t index)>;
+
+		worker_pool(std::size_t num_threads);
+
+		worker_pool(worker_pool const&) = delete;
+
+		worker_pool& operator=(worker_pool const&) = delete;
+
+		~worker_pool();
+
+		std::size_t get_num_threads() const;
+
+		void run(std::size_t count, task const& task);
+
+	private:
+
+		void work();
+
+		void process();
+
+		std::vector<std::thread>	threads_;
+		std::mutex					mutex_;
+		std::condition_variable		wake_;
+		std::condition_variable		done_;
+		task const*					task_		= nullptr;
+		std::size_t					count_		= 0;
+		std::atomic<std::size_t>	next_;
+		std::size_t					busy_		= 0;
+		std::size_t					batch_		= 0;
+		bool						stop_		= false;
+	};
+}
@@ -0,0 +1,650 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/lockstep_cpu.hpp>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define NAIVE_GBE_X86 1
+	#include <immintrin.h>
+#else
+	#define NAIVE_GBE_X86 0
+#endif
+
+#if defined(__GNUC__)
+	#define NAIVE_GBE_TARGET(name) __attribute__((target(name)))
+#else
+	#define NAIVE_GBE_TARGET(name)
+#endif
+
+namespace naive_gbe
+{
+	namespace
+	{
+		using alu_op = lockstep_cpu::alu_op;
+
+		bool uses_carry(alu_op op)
+		{
+			return op == alu_op::ADC || op == alu_op::SBC;
+		}
+
+		void alu_scalar(alu_op op, std::uint8_t* a, std::uint8_t const* rhs, std::uint8_t* f, std::uint8_t const* mask, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (!mask[i])
+					continue;
+
+				std::uint8_t lhs = a[i];
+				std::uint8_t value = rhs[i];
+				std::uint8_t carry = uses_carry(op) && (f[i] & lr35902::CARRY) ? 1 : 0;
+				std::uint8_t result = 0;
+				std::uint8_t flags = 0;
+
+				switch (op)
+				{
+				case alu_op::ADD:
+				case alu_op::ADC:
+					result = lhs + value + carry;
+
+					if ((lhs + value + carry) & 0x0100)
+						flags |= lr35902::CARRY;
+
+					if (((lhs & 0x0f) + (value & 0x0f) + carry) & 0x0010)
+						flags |= lr35902::HALF_CARRY;
+					break;
+				case alu_op::SUB:
+				case alu_op::SBC:
+				case alu_op::CP:
+					result = lhs - value - carry;
+					flags = lr35902::SUBTRACTION;
+
+					if (value + carry > lhs)
+						flags |= lr35902::CARRY;
+
+					if ((value & 0x0f) + carry > (lhs & 0x0f))
+						flags |= lr35902::HALF_CARRY;
+					break;
+				case alu_op::AND:
+					result = lhs & value;
+					flags = lr35902::HALF_CARRY;
+					break;
+				case alu_op::XOR:
+					result = lhs ^ value;
+					break;
+				case alu_op::OR:
+					result = lhs | value;
+					break;
+				}
+
+				if (!result)
+					flags |= lr35902::ZERO;
+
+				if (op != alu_op::CP)
+					a[i] = result;
+
+				f[i] = flags;
+			}
+		}
+
+		void inc_dec_scalar(bool decrement, std::uint8_t* reg, std::uint8_t* f, std::uint8_t const* mask, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (!mask[i])
+					continue;
+
+				std::uint8_t value = decrement ? reg[i] - 1 : reg[i] + 1;
+				std::uint8_t flags = f[i] & lr35902::CARRY;
+
+				if (decrement)
+					flags |= lr35902::SUBTRACTION;
+
+				if (value & 0x10)
+					flags |= lr35902::HALF_CARRY;
+				else if (!value)
+					flags |= lr35902::ZERO;
+
+				reg[i] = value;
+				f[i] = flags;
+			}
+		}
+
+		void move_scalar(std::uint8_t* dst, std::uint8_t const* src, std::uint8_t const* mask, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (mask[i])
+					dst[i] = src[i];
+			}
+		}
+
+		std::uint64_t match_scalar(std::uint16_t const* pc, std::uint16_t value, std::size_t count)
+		{
+			std::uint64_t bits = 0;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (pc[i] == value)
+					bits |= std::uint64_t{ 1 } << i;
+			}
+
+			return bits;
+		}
+
+		std::size_t lowest_bit(std::uint64_t bits)
+		{
+#if defined(__GNUC__)
+			return __builtin_ctzll(bits);
+#else
+			std::size_t index = 0;
+
+			for (; !(bits & 1); bits >>= 1)
+				++index;
+
+			return index;
+#endif
+		}
+
+#if NAIVE_GBE_X86
+		NAIVE_GBE_TARGET("sse2")
+		inline __m128i blend_sse2(__m128i mask, __m128i value, __m128i old)
+		{
+			return _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, old));
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		inline __m128i half_carry_sse2(__m128i lhs, __m128i rhs, __m128i result)
+		{
+			// Bit 4 of lhs ^ rhs ^ result is the carry (or borrow) out of the low nibble.
+			__m128i bits = _mm_xor_si128(_mm_xor_si128(lhs, rhs), result);
+
+			return _mm_and_si128(_mm_slli_epi16(bits, 1), _mm_set1_epi8(lr35902::HALF_CARRY));
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		void alu_sse2(alu_op op, std::uint8_t* a, std::uint8_t const* rhs, std::uint8_t* f, std::uint8_t const* mask, std::size_t count)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i one = _mm_set1_epi8(1);
+			const __m128i all = _mm_cmpeq_epi8(zero, zero);
+			const __m128i carry_flag = _mm_set1_epi8(lr35902::CARRY);
+			const __m128i zero_flag = _mm_set1_epi8(static_cast<char>(lr35902::ZERO));
+
+			for (std::size_t i = 0; i < count; i += lockstep_cpu::VECTOR_LANES)
+			{
+				__m128i m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask + i));
+				__m128i lhs = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+				__m128i value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rhs + i));
+				__m128i flags = _mm_loadu_si128(reinterpret_cast<__m128i const*>(f + i));
+				__m128i carry = uses_carry(op) ? _mm_and_si128(_mm_srli_epi16(flags, 4), one) : zero;
+				__m128i carry_in = _mm_cmpeq_epi8(carry, one);
+				__m128i result;
+				__m128i out;
+
+				switch (op)
+				{
+				case alu_op::ADD:
+				case alu_op::ADC:
+				{
+					__m128i sum = _mm_add_epi8(lhs, value);
+					__m128i overflow = _mm_xor_si128(_mm_cmpeq_epi8(_mm_adds_epu8(lhs, value), sum), all);
+
+					overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_cmpeq_epi8(sum, all), carry_in));
+					result = _mm_add_epi8(sum, carry);
+					out = _mm_or_si128(_mm_and_si128(overflow, carry_flag), half_carry_sse2(lhs, value, result));
+					break;
+				}
+				case alu_op::SUB:
+				case alu_op::SBC:
+				case alu_op::CP:
+				{
+					__m128i diff = _mm_sub_epi8(lhs, value);
+					__m128i borrow = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(value, lhs), zero), all);
+
+					borrow = _mm_or_si128(borrow, _mm_and_si128(_mm_cmpeq_epi8(diff, zero), carry_in));
+					result = _mm_sub_epi8(diff, carry);
+					out = _mm_or_si128(_mm_and_si128(borrow, carry_flag), half_carry_sse2(lhs, value, result));
+					out = _mm_or_si128(out, _mm_set1_epi8(lr35902::SUBTRACTION));
+					break;
+				}
+				case alu_op::AND:
+					result = _mm_and_si128(lhs, value);
+					out = _mm_set1_epi8(lr35902::HALF_CARRY);
+					break;
+				case alu_op::XOR:
+					result = _mm_xor_si128(lhs, value);
+					out = zero;
+					break;
+				default:
+					result = _mm_or_si128(lhs, value);
+					out = zero;
+					break;
+				}
+
+				out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi8(result, zero), zero_flag));
+
+				if (op != alu_op::CP)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), blend_sse2(m, result, lhs));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(f + i), blend_sse2(m, out, flags));
+			}
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		void inc_dec_sse2(bool decrement, std::uint8_t* reg, std::uint8_t* f, std::uint8_t const* mask, std::size_t count)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i delta = _mm_set1_epi8(decrement ? -1 : 1);
+			const __m128i bit4 = _mm_set1_epi8(0x10);
+			const __m128i keep = _mm_set1_epi8(lr35902::CARRY);
+			const __m128i subtraction = _mm_set1_epi8(decrement ? lr35902::SUBTRACTION : 0);
+			const __m128i zero_flag = _mm_set1_epi8(static_cast<char>(lr35902::ZERO));
+
+			for (std::size_t i = 0; i < count; i += lockstep_cpu::VECTOR_LANES)
+			{
+				__m128i m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask + i));
+				__m128i value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(reg + i));
+				__m128i flags = _mm_loadu_si128(reinterpret_cast<__m128i const*>(f + i));
+				__m128i result = _mm_add_epi8(value, delta);
+
+				__m128i out = _mm_or_si128(_mm_and_si128(flags, keep), subtraction);
+				out = _mm_or_si128(out, _mm_slli_epi16(_mm_and_si128(result, bit4), 1));
+				out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi8(result, zero), zero_flag));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(reg + i), blend_sse2(m, result, value));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(f + i), blend_sse2(m, out, flags));
+			}
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		void move_sse2(std::uint8_t* dst, std::uint8_t const* src, std::uint8_t const* mask, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i += lockstep_cpu::VECTOR_LANES)
+			{
+				__m128i m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask + i));
+				__m128i value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+				__m128i old = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blend_sse2(m, value, old));
+			}
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		std::uint64_t match_sse2(std::uint16_t const* pc, std::uint16_t value, std::size_t count)
+		{
+			const __m128i key = _mm_set1_epi16(static_cast<short>(value));
+			std::uint64_t bits = 0;
+
+			for (std::size_t i = 0; i < count; i += lockstep_cpu::VECTOR_LANES)
+			{
+				__m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pc + i)), key);
+				__m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pc + i + 8)), key);
+
+				bits |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi))) << i;
+			}
+
+			return bits;
+		}
+#endif
+	}
+
+	lockstep_cpu::lockstep_cpu(std::size_t num_lanes, buffer const& rom, isa isa)
+	{
+		while (!is_supported(isa))
+			isa = static_cast<lockstep_cpu::isa>(static_cast<std::uint8_t>(isa) - 1);
+
+		isa_ = isa;
+
+		switch (isa)
+		{
+#if NAIVE_GBE_X86
+		case isa::SSE2:
+			alu_ = &alu_sse2;
+			inc_dec_ = &inc_dec_sse2;
+			move_ = &move_sse2;
+			match_ = &match_sse2;
+			break;
+#endif
+		default:
+			alu_ = &alu_scalar;
+			inc_dec_ = &inc_dec_scalar;
+			move_ = &move_scalar;
+			match_ = &match_scalar;
+			break;
+		}
+
+		// Kernels always work on whole vectors, so the lane arrays are padded with idle lanes.
+		std::size_t padded = (num_lanes + VECTOR_LANES - 1) / VECTOR_LANES * VECTOR_LANES;
+
+		for (auto& reg : regs_)
+			reg.resize(padded);
+
+		imm_.resize(padded);
+		group_.resize(padded);
+
+		sp_.resize(padded);
+		pc_.resize(padded);
+		cycle_.resize(padded);
+		limit_.resize(padded);
+		frame_.resize(padded);
+
+		for (std::size_t lane = 0; lane < num_lanes; ++lane)
+		{
+			lanes_.push_back(std::make_unique<emulator>());
+			lanes_.back()->set_cartridge(cartridge{ buffer{ rom } });
+			load_registers(lane);
+		}
+
+		if (!lanes_.empty())
+			set_decode_table();
+	}
+
+	lockstep_cpu::isa lockstep_cpu::get_isa() const
+	{
+		return isa_;
+	}
+
+	bool lockstep_cpu::is_supported(isa isa)
+	{
+		switch (isa)
+		{
+		case isa::SCALAR:
+			return true;
+#if NAIVE_GBE_X86
+		case isa::SSE2:
+			return pixel_kernels::is_supported(isa);
+#endif
+		default:
+			return false;
+		}
+	}
+
+	std::size_t lockstep_cpu::get_num_lanes() const
+	{
+		return lanes_.size();
+	}
+
+	emulator& lockstep_cpu::get_emulator(std::size_t lane)
+	{
+		return *lanes_[lane];
+	}
+
+	void lockstep_cpu::run_frame()
+	{
+		// Registers are reloaded every frame, so changes made through get_emulator() between frames are kept.
+		for (std::size_t lane = 0; lane < lanes_.size(); ++lane)
+		{
+			auto& emu = *lanes_[lane];
+
+			load_registers(lane);
+			frame_[lane] = emu.get_ppu().get_frame();
+			limit_[lane] = cycle_[lane] + ppu::CYCLES_PER_FRAME;
+		}
+
+		for (std::size_t first = 0; first < lanes_.size(); first += BLOCK_LANES)
+			run_block(first, std::min<std::size_t>(first + BLOCK_LANES, lanes_.size()));
+
+		for (std::size_t lane = 0; lane < lanes_.size(); ++lane)
+			store_registers(lane);
+	}
+
+	std::uint8_t lockstep_cpu::get_register(std::size_t lane, r8 reg) const
+	{
+		return regs_[static_cast<std::size_t>(reg)][lane];
+	}
+
+	std::uint16_t lockstep_cpu::get_register(std::size_t lane, r16 reg) const
+	{
+		switch (reg)
+		{
+		case r16::SP:
+			return sp_[lane];
+		case r16::PC:
+			return pc_[lane];
+		default:
+			return regs_[static_cast<std::size_t>(reg)][lane] << 8 | regs_[static_cast<std::size_t>(reg) + 1][lane];
+		}
+	}
+
+	std::size_t lockstep_cpu::get_cycle(std::size_t lane) const
+	{
+		return cycle_[lane];
+	}
+
+	lockstep_cpu::statistics const& lockstep_cpu::get_statistics() const
+	{
+		return statistics_;
+	}
+
+	void lockstep_cpu::set_decode_table()
+	{
+		constexpr std::uint8_t NONE = 0xff;
+		constexpr std::uint8_t A = static_cast<std::uint8_t>(r8::A);
+		static const std::uint8_t regs[] = { 2, 3, 4, 5, 6, 7, NONE, A };
+
+		auto const& cpu = lanes_.front()->get_cpu();
+		auto set = [this, &cpu](std::uint8_t opcode, op_kind kind, std::uint8_t dst, std::uint8_t src, std::uint8_t size) -> decoded_op&
+		{
+			auto& op = decoded_[opcode];
+
+			op.kind_ = kind;
+			op.dst_ = dst;
+			op.src_ = src;
+			op.size_ = size;
+			op.cycles_ = cpu.get_cycles(opcode);
+
+			return op;
+		};
+
+		set(0x00, op_kind::NOP, 0, 0, 1);
+
+		for (std::uint8_t code = 0; code < 8; ++code)
+		{
+			if (regs[code] == NONE)
+				continue;
+
+			set(0x04 | code << 3, op_kind::INC, regs[code], 0, 1);
+			set(0x05 | code << 3, op_kind::DEC, regs[code], 0, 1);
+			set(0x06 | code << 3, op_kind::MOVE_D8, regs[code], 0, 2);
+
+			for (std::uint8_t src = 0; src < 8; ++src)
+			{
+				if (regs[src] != NONE)
+					set(0x40 | code << 3 | src, op_kind::MOVE, regs[code], regs[src], 1);
+			}
+		}
+
+		for (std::uint8_t alu = 0; alu < 8; ++alu)
+		{
+			for (std::uint8_t src = 0; src < 8; ++src)
+			{
+				if (regs[src] != NONE)
+					set(0x80 | alu << 3 | src, op_kind::ALU, A, regs[src], 1).alu_ = static_cast<alu_op>(alu);
+			}
+
+			set(0xc6 | alu << 3, op_kind::ALU_D8, A, 0, 2).alu_ = static_cast<alu_op>(alu);
+		}
+
+		set(0x18, op_kind::JR, 0, 0, 2);
+
+		for (std::uint8_t opcode : { 0x20, 0x28, 0x30, 0x38 })
+		{
+			auto& op = set(opcode, op_kind::JR_COND, 0, 0, 2);
+
+			op.flag_ = opcode & 0x10 ? lr35902::CARRY : lr35902::ZERO;
+			op.state_ = !(opcode & 0x08);
+		}
+	}
+
+	void lockstep_cpu::load_registers(std::size_t lane)
+	{
+		auto const& cpu = lanes_[lane]->get_cpu();
+		auto const& registers = cpu.get_registers();
+
+		for (std::size_t reg = 0; reg < NUM_R8; ++reg)
+			regs_[reg][lane] = registers[reg];
+
+		sp_[lane] = cpu.get_register(r16::SP);
+		pc_[lane] = cpu.get_register(r16::PC);
+		cycle_[lane] = cpu.get_cycle();
+	}
+
+	void lockstep_cpu::store_registers(std::size_t lane)
+	{
+		lr35902::register_file registers;
+
+		for (std::size_t reg = 0; reg < NUM_R8; ++reg)
+			registers[reg] = regs_[reg][lane];
+
+		registers[static_cast<std::size_t>(r16::SP)] = sp_[lane] >> 8;
+		registers[static_cast<std::size_t>(r16::SP) + 1] = sp_[lane] & 0xff;
+		registers[static_cast<std::size_t>(r16::PC)] = pc_[lane] >> 8;
+		registers[static_cast<std::size_t>(r16::PC) + 1] = pc_[lane] & 0xff;
+
+		lanes_[lane]->get_cpu().set_registers(registers, cycle_[lane]);
+	}
+
+	void lockstep_cpu::run_block(std::size_t first, std::size_t last)
+	{
+		std::size_t count = (last - first + VECTOR_LANES - 1) / VECTOR_LANES * VECTOR_LANES;
+		std::uint64_t running = 0;
+
+		for (std::size_t lane = first; lane < last; ++lane)
+		{
+			if (lanes_[lane]->get_cpu().get_state() != lr35902::state::STOPPED)
+				running |= std::uint64_t{ 1 } << (lane - first);
+		}
+
+		// Every running lane executes exactly one instruction per round.
+		while (running)
+		{
+			for (std::uint64_t pending = running; pending; )
+				pending &= ~run_group(first, count, pending, running);
+		}
+	}
+
+	std::uint64_t lockstep_cpu::run_group(std::size_t first, std::size_t count, std::uint64_t pending, std::uint64_t& running)
+	{
+		std::size_t leader = first + lowest_bit(pending);
+		std::uint16_t pc = pc_[leader];
+		std::uint8_t opcode = lanes_[leader]->get_mmu().fetch(pc);
+		auto const& op = decoded_[opcode];
+		std::uint64_t leader_bit = std::uint64_t{ 1 } << (leader - first);
+
+		if (op.kind_ == op_kind::SCALAR)
+		{
+			if (!step_scalar(leader))
+				running &= ~leader_bit;
+
+			return leader_bit;
+		}
+
+		std::uint64_t candidates = match_(pc_.data() + first, pc, count) & pending;
+		std::uint64_t group = 0;
+		std::size_t back = leader;
+
+		for (std::uint64_t bits = candidates; bits; bits &= bits - 1)
+		{
+			std::size_t lane = first + lowest_bit(bits);
+			auto const& mmu = lanes_[lane]->get_mmu();
+
+			// Banked or ram code can differ between lanes at the same pc.
+			if (lane != leader && mmu.fetch(pc) != opcode)
+				continue;
+
+			if (op.size_ > 1)
+				imm_[lane] = mmu.read(static_cast<std::uint16_t>(pc + 1));
+
+			group_[lane] = 0xff;
+			group |= std::uint64_t{ 1 } << (lane - first);
+			back = lane;
+		}
+
+		// Only the vectors holding group members are touched.
+		std::size_t begin = (leader - first) / VECTOR_LANES * VECTOR_LANES + first;
+		std::size_t end = (back - first) / VECTOR_LANES * VECTOR_LANES + first + VECTOR_LANES;
+
+		auto reg = [this, begin](std::uint8_t index) { return regs_[index].data() + begin; };
+		auto* flags = reg(static_cast<std::uint8_t>(r8::F));
+		auto* a = reg(static_cast<std::uint8_t>(r8::A));
+		auto const* mask = group_.data() + begin;
+		auto const* imm = imm_.data() + begin;
+
+		switch (op.kind_)
+		{
+		case op_kind::MOVE:
+			move_(reg(op.dst_), reg(op.src_), mask, end - begin);
+			break;
+		case op_kind::MOVE_D8:
+			move_(reg(op.dst_), imm, mask, end - begin);
+			break;
+		case op_kind::INC:
+		case op_kind::DEC:
+			inc_dec_(op.kind_ == op_kind::DEC, reg(op.dst_), flags, mask, end - begin);
+			break;
+		case op_kind::ALU:
+			alu_(op.alu_, a, reg(op.src_), flags, mask, end - begin);
+			break;
+		case op_kind::ALU_D8:
+			alu_(op.alu_, a, imm, flags, mask, end - begin);
+			break;
+		default:
+			break;
+		}
+
+		++statistics_.groups_;
+
+		for (std::uint64_t bits = group; bits; bits &= bits - 1)
+		{
+			std::size_t lane = first + lowest_bit(bits);
+			std::uint16_t next = pc + op.size_;
+			std::uint64_t cycles = op.cycles_;
+
+			if (op.kind_ == op_kind::JR || (op.kind_ == op_kind::JR_COND &&
+				static_cast<bool>(regs_[static_cast<std::size_t>(r8::F)][lane] & op.flag_) != op.state_))
+			{
+				next += static_cast<std::int8_t>(imm_[lane]);
+
+				if (op.kind_ == op_kind::JR_COND)
+					cycles += 4;
+			}
+
+			pc_[lane] = next;
+			cycle_[lane] += cycles;
+			group_[lane] = 0;
+			lanes_[lane]->get_mmu().get_scheduler().run(cycle_[lane]);
+
+			if (!is_running(lane))
+				running &= ~(std::uint64_t{ 1 } << (lane - first));
+
+			++statistics_.vector_steps_;
+		}
+
+		return group;
+	}
+
+	bool lockstep_cpu::step_scalar(std::size_t lane)
+	{
+		store_registers(lane);
+		lanes_[lane]->get_cpu().step();
+		load_registers(lane);
+
+		++statistics_.scalar_steps_;
+
+		return is_running(lane);
+	}
+
+	bool lockstep_cpu::is_running(std::size_t lane)
+	{
+		auto& emu = *lanes_[lane];
+
+		return emu.get_ppu().get_frame() == frame_[lane]
+			&& cycle_[lane] < limit_[lane]
+			&& emu.get_cpu().get_state() != lr35902::state::STOPPED;
+	}
+}
@@ -7,99 +7,571 @@
 #include <naive_gbe/mmu.hpp>
 
 #include <cassert>
-#include <functional>
+#include <cstring>
 #include <algorithm>
-#include <iomanip>
-#include <chrono>
-#include <cassert>
 
 namespace naive_gbe
 {
 	mmu::mmu()
+		: video_ram_(0x2000, 0)
+		, work_ram_(0x2000, 0)
+		, high_ram_(0x0200, 0)
 	{
 		bootstrap_ = get_bootstrap();
+
+		assign(0x0000, 0x10000, &mmu::read_open_bus, nullptr, this);
+		assign(0x0000, 0x0100, bootstrap_.data(), address::access_mode::READ_ONLY);
+		assign(0x8000, 0x2000, video_ram_.data(), address::access_mode::READ_WRITE);
+		assign(0xc000, 0x2000, work_ram_.data(), address::access_mode::READ_WRITE);
+		assign(0xe000, 0x1e00, work_ram_.data(), address::access_mode::READ_WRITE);
+		assign(0xfe00, 0x0100, high_ram_.data(), address::access_mode::READ_WRITE);
+		assign(0xff00, 0x0100, high_ram_.data() + 0x0100, address::access_mode::READ_ONLY);
+
+		layout_[0xff].read_ = nullptr;
+		layout_[0xff].on_read_ = &mmu::read_io;
+		layout_[0xff].on_write_ = &mmu::write_io;
+		layout_[0xff].context_ = this;
+
+		for (std::size_t index = 0x80; index < 0x80 + (VIDEO_RAM_SIZE >> PAGE_SHIFT); ++index)
+		{
+			layout_[index].write_ = nullptr;
+			layout_[index].on_write_ = &mmu::write_video_ram;
+			layout_[index].context_ = this;
+		}
+
+		layout_[0xfe].write_ = nullptr;
+		layout_[0xfe].on_write_ = &mmu::write_oam;
+		layout_[0xfe].context_ = this;
+
+		set_io_handler(0xff46, &mmu::write_dma, this);
+		set_io_handler(0xff50, &mmu::write_bootstrap, this);
+
+		map_cartridge();
+		map_external_ram();
+
 		reset();
 	}
 
-	address& mmu::operator[](std::uint16_t addr)
+	address mmu::operator[](std::uint16_t addr)
 	{
-		return memory_[addr];
+		return address{ *this, addr };
 	}
 
-	address const& mmu::operator[](std::uint16_t addr) const
+	std::uint8_t mmu::operator[](std::uint16_t addr) const
 	{
-		return memory_[addr];
+		return read(addr);
 	}
 
 	void mmu::set_bootstrap(buffer&& bootstrap)
 	{
-		bootstrap_ = bootstrap;
+		bool enabled = get_origin(0).read_ == bootstrap_.data();
+
+		bootstrap_ = std::move(bootstrap);
+		bootstrap_.resize(PAGE_SIZE, 0xff);
+
+		assign(0x0000, 0x0100, bootstrap_.data(), address::access_mode::READ_ONLY);
+
+		if (enabled)
+			commit(0x0000, 0x0100);
 	}
 
 	void mmu::set_cartridge(cartridge&& cartridge)
 	{
-		cartridge_ = cartridge;
+		cartridge_ = std::move(cartridge);
+
+#if NAIVE_GBE_HEATMAP
+		heatmap_.set_rom_size(cartridge_.get_data().size());
+#endif
+
+		external_ram_.open(cartridge_.get_ram_size());
+
+		map_cartridge();
+		map_external_ram();
+	}
+
+	bool mmu::load_save_ram(std::string const& file_name, std::error_code& ec)
+	{
+		bool loaded = external_ram_.open(file_name, cartridge_.get_ram_size(), ec);
+
+		if (!loaded)
+			external_ram_.open(cartridge_.get_ram_size());
+
+		map_external_ram();
+
+		return loaded;
+	}
+
+	save_ram& mmu::get_save_ram()
+	{
+		return external_ram_;
+	}
+
+	void mmu::set_io_handler(std::uint16_t addr, write_handler handler, void* context)
+	{
+		io_handlers_[addr & (PAGE_SIZE - 1)] = io_handler{ handler, context };
+	}
+
+	void mmu::set_video_ram_handler(write_handler handler, void* context)
+	{
+		video_ram_handler_ = io_handler{ handler, context };
+	}
+
+	void mmu::set_oam_handler(write_handler handler, void* context)
+	{
+		oam_handler_ = io_handler{ handler, context };
+	}
+
+	void mmu::set_sync_handler(sync_handler handler, void* context)
+	{
+		sync_ = handler;
+		sync_context_ = context;
+	}
+
+	std::uint8_t mmu::get_io(std::uint16_t addr) const
+	{
+		return high_ram_[PAGE_SIZE + (addr & (PAGE_SIZE - 1))];
+	}
+
+	void mmu::set_io(std::uint16_t addr, std::uint8_t value)
+	{
+		high_ram_[PAGE_SIZE + (addr & (PAGE_SIZE - 1))] = value;
+	}
+
+	void mmu::request_interrupt(interrupt mask)
+	{
+		high_ram_[PAGE_SIZE + (IO_REG_IF & (PAGE_SIZE - 1))] |= mask;
+	}
+
+	std::uint8_t const* mmu::get_video_ram() const
+	{
+		return video_ram_.data();
+	}
+
+	std::uint8_t const* mmu::get_oam() const
+	{
+		return high_ram_.data();
+	}
+
+	scheduler& mmu::get_scheduler()
+	{
+		return scheduler_;
+	}
+
+	bool mmu::is_dma_active() const
+	{
+		return dma_active_;
+	}
+
+	void mmu::set_pc_source(pc_source source)
+	{
+		pc_source_ = source;
+	}
 
-		std::uint16_t addr = 0x0000;
-		std::uint8_t* data = nullptr;
+	std::size_t mmu::add_watchpoint(std::uint16_t first, std::uint16_t last, watch_mode mode, watch_callback callback)
+	{
+		std::size_t id = ++next_watch_id_;
+
+		watchpoints_.emplace_back(watchpoint{ id, first, last, mode, callback });
+		update_watched_pages();
 
-		addr = 0x0100;
-		data = cartridge_.get_data().data() + 0x0100;
-		while (addr < 0x014f)
-			memory_[addr++].set(data++, address::access_mode::READ_ONLY);
+		return id;
 	}
 
+	void mmu::remove_watchpoint(std::size_t id)
+	{
+		auto it = std::remove_if(watchpoints_.begin(), watchpoints_.end(),
+			[id](watchpoint const& wp) { return wp.id_ == id; });
+
+		watchpoints_.erase(it, watchpoints_.end());
+		update_watched_pages();
+	}
+
+	void mmu::clear_watchpoints()
+	{
+		watchpoints_.clear();
+		update_watched_pages();
+	}
+
+#if NAIVE_GBE_HEATMAP
+	heatmap& mmu::get_heatmap()
+	{
+		return heatmap_;
+	}
+
+	heatmap const& mmu::get_heatmap() const
+	{
+		return heatmap_;
+	}
+#endif
+
 	void mmu::reset()
 	{
-		memory_.assign(0x10000, address{ 0, address::access_mode::READ_WRITE });
+		pages_ = layout_;
+
+#if NAIVE_GBE_HEATMAP
+		for (std::size_t index = 0; index < heatmap::ROM_PAGES; ++index)
+			update_heatmap_page(index, pages_[index]);
+#endif
+
+		dma_active_ = false;
+		scheduler_.reset();
+
+		if (!watchpoints_.empty())
+		{
+			watched_.fill(0);
+			update_watched_pages();
+		}
+
+		std::memset(video_ram_.data(), 0, video_ram_.size());
+		std::memset(work_ram_.data(), 0, work_ram_.size());
+		std::memset(high_ram_.data(), 0, high_ram_.size());
+	}
+
+	std::uint8_t mmu::read_open_bus(void* context, std::uint16_t addr)
+	{
+		return 0xff;
+	}
+
+	std::uint8_t mmu::read_io(void* context, std::uint16_t addr)
+	{
+		auto self = static_cast<mmu*>(context);
+
+		self->sync(addr);
+
+		return self->high_ram_[PAGE_SIZE + (addr & (PAGE_SIZE - 1))];
+	}
+
+	void mmu::write_io(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<mmu*>(context);
+		std::size_t offset = addr & (PAGE_SIZE - 1);
+
+		self->sync(addr);
+		self->high_ram_[PAGE_SIZE + offset] = value;
 
-		invalid_.assign(0x10000, 0);
-		video_ram_.assign(0x2000, 0);
+		auto const& handler = self->io_handlers_[offset];
 
-		std::size_t addr = 0x0000;
-		std::uint8_t* data = nullptr;
+		if (handler.on_write_)
+			handler.on_write_(handler.context_, addr, value);
+	}
+
+	void mmu::write_external_ram(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<mmu*>(context);
+		std::size_t offset = addr - 0xa000u;
+
+		self->external_ram_.get_data()[offset] = value;
+		self->external_ram_.mark_dirty(offset);
+	}
+
+	void mmu::write_video_ram(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<mmu*>(context);
 
-		addr = 0x0000;
-		data = invalid_.data();
-		while (addr < 0x10000)
-			memory_[addr++].set(data++, address::access_mode::READ_WRITE);
+		if (self->sync_)
+			self->sync_(self->sync_context_, addr);
 
-		addr = 0x0000;
-		data = bootstrap_.data();
-		while (addr < 0x0100)
-			memory_[addr++].set(data++, address::access_mode::READ_ONLY);
+		self->video_ram_[addr - 0x8000u] = value;
 
-		addr = 0x8000;
-		data = video_ram_.data();
-		while (addr < 0x9fff)
-			memory_[addr++].set(data++, address::access_mode::READ_WRITE);
+		auto const& handler = self->video_ram_handler_;
 
-		memory_[0xff50].set(std::bind(&mmu::disable_bootstrap, this, std::placeholders::_1));
+		if (handler.on_write_)
+			handler.on_write_(handler.context_, addr, value);
+	}
+
+	void mmu::write_oam(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<mmu*>(context);
+
+		if (self->sync_)
+			self->sync_(self->sync_context_, addr);
+
+		self->high_ram_[addr - 0xfe00u] = value;
+
+		auto const& handler = self->oam_handler_;
+
+		if (handler.on_write_)
+			handler.on_write_(handler.context_, addr, value);
+	}
+
+	void mmu::write_bootstrap(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		static_cast<mmu*>(context)->disable_bootstrap();
+	}
+
+	void mmu::write_dma(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		static_cast<mmu*>(context)->start_dma(value);
+	}
 
-		if (!cartridge_.get_data().empty())
+	void mmu::end_dma(void* context, std::uint64_t cycle)
+	{
+		auto self = static_cast<mmu*>(context);
+
+		std::copy_n(self->dma_pages_.begin(), NUM_PAGES - 1, self->pages_.begin());
+		self->dma_active_ = false;
+	}
+
+	std::uint8_t mmu::read_watched(void* context, std::uint16_t addr)
+	{
+		auto self = static_cast<mmu*>(context);
+		page const& origin = self->watched_pages_[addr >> PAGE_SHIFT];
+
+		std::uint8_t value = origin.read_ ?
+			origin.read_[addr & (PAGE_SIZE - 1)] :
+			origin.on_read_(origin.context_, addr);
+
+		self->notify(addr, value, WATCH_READ);
+
+		return value;
+	}
+
+	void mmu::write_watched(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<mmu*>(context);
+		page const& origin = self->watched_pages_[addr >> PAGE_SHIFT];
+
+		if (origin.write_)
+			origin.write_[addr & (PAGE_SIZE - 1)] = value;
+		else if (origin.on_write_)
+			origin.on_write_(origin.context_, addr, value);
+
+		self->notify(addr, value, WATCH_WRITE);
+	}
+
+	mmu::page& mmu::get_page(std::size_t index)
+	{
+		return dma_active_ && index < NUM_PAGES - 1 ? dma_pages_[index] : pages_[index];
+	}
+
+	mmu::page& mmu::get_origin(std::size_t index)
+	{
+		return watched_[index] ? watched_pages_[index] : get_page(index);
+	}
+
+	void mmu::sync(std::uint16_t addr) const
+	{
+		if (!sync_)
+			return;
+
+		if (addr == IO_REG_IF || (addr >= IO_REG_LCD_FIRST && addr <= IO_REG_LCD_LAST))
+			sync_(sync_context_, addr);
+	}
+
+	void mmu::set_page(std::size_t index, page const& origin)
+	{
+		update_heatmap_page(index, origin);
+
+		if (!watched_[index])
+		{
+			get_page(index) = origin;
+			return;
+		}
+
+		std::uint8_t mode = watched_[index];
+		page trap = origin;
+
+		watched_pages_[index] = origin;
+		trap.context_ = this;
+
+		if ((mode & WATCH_READ) || !origin.read_)
+		{
+			trap.read_ = nullptr;
+			trap.on_read_ = &mmu::read_watched;
+		}
+
+		if ((mode & WATCH_WRITE) || !origin.write_)
 		{
-			addr = 0x0100;
-			data = cartridge_.get_data().data() + 0x0100;
-			while (addr < 0x014f)
-				memory_[addr++].set(data++, address::access_mode::READ_ONLY);
+			trap.write_ = nullptr;
+			trap.on_write_ = &mmu::write_watched;
 		}
+
+		get_page(index) = trap;
+	}
+
+	void mmu::update_watched_pages()
+	{
+		std::array<std::uint8_t, NUM_PAGES> modes = {};
+
+		for (auto const& wp : watchpoints_)
+		{
+			for (std::size_t index = wp.first_ >> PAGE_SHIFT; index <= std::size_t{ wp.last_ } >> PAGE_SHIFT; ++index)
+				modes[index] |= wp.mode_;
+		}
+
+		for (std::size_t index = 0; index < NUM_PAGES; ++index)
+		{
+			if (modes[index] == watched_[index])
+				continue;
+
+			page origin = get_origin(index);
+
+			watched_[index] = modes[index];
+			set_page(index, origin);
+		}
+	}
+
+	void mmu::update_heatmap_page(std::size_t index, page const& origin)
+	{
+#if NAIVE_GBE_HEATMAP
+		if (index >= heatmap::ROM_PAGES)
+			return;
+
+		auto const& data = cartridge_.get_data();
+		std::int64_t offset = -1;
+
+		if (origin.read_ >= data.data() && origin.read_ < data.data() + data.size())
+			offset = origin.read_ - data.data();
+
+		heatmap_.map_rom_page(index, offset);
+#endif
+	}
+
+	void mmu::notify(std::uint16_t addr, std::uint8_t value, watch_mode access)
+	{
+		for (std::size_t i = 0; i < watchpoints_.size(); ++i)
+		{
+			auto const& wp = watchpoints_[i];
+
+			if (!(wp.mode_ & access) || addr < wp.first_ || addr > wp.last_)
+				continue;
+
+			watch_event event{ addr, value, 0, scheduler_.get_cycle(), access };
+
+			if (pc_source_)
+				event.pc_ = pc_source_();
+
+			wp.callback_(event);
+		}
+	}
+
+	void mmu::disable_bootstrap()
+	{
+		auto& data = cartridge_.get_data();
+
+		if (data.empty())
+			set_page(0, page{ nullptr, nullptr, &mmu::read_open_bus, nullptr, this });
+		else
+			set_page(0, page{ data.data(), nullptr, nullptr, nullptr, nullptr });
+	}
+
+	void mmu::start_dma(std::uint8_t source)
+	{
+		page const& from = get_origin(source);
+		std::uint8_t* oam = high_ram_.data();
+
+		if (sync_)
+			sync_(sync_context_, 0xfe00);
+
+		if (from.read_)
+		{
+			std::memmove(oam, from.read_, OAM_SIZE);
+		}
+		else
+		{
+			std::uint16_t addr = source << PAGE_SHIFT;
+
+			for (std::size_t offset = 0; offset < OAM_SIZE; ++offset)
+				oam[offset] = from.on_read_(from.context_, static_cast<std::uint16_t>(addr + offset));
+		}
+
+		if (oam_handler_.on_write_)
+		{
+			for (std::size_t offset = 0; offset < OAM_SIZE; ++offset)
+				oam_handler_.on_write_(oam_handler_.context_, static_cast<std::uint16_t>(0xfe00 + offset), oam[offset]);
+		}
+
+		if (!dma_active_)
+		{
+			std::copy_n(pages_.begin(), NUM_PAGES - 1, dma_pages_.begin());
+			std::fill_n(pages_.begin(), NUM_PAGES - 1, page{ nullptr, nullptr, &mmu::read_open_bus, nullptr, this });
+			dma_active_ = true;
+		}
+
+		scheduler_.schedule(scheduler::EVENT_DMA_END, scheduler_.get_cycle() + DMA_CYCLES, &mmu::end_dma, this);
 	}
 
 	void mmu::assign(std::uint16_t addr, std::size_t size, std::uint8_t* data, address::access_mode mode)
 	{
-		while (addr < addr + size)
-			memory_[addr++].set(data++, mode);
+		assert((addr & (PAGE_SIZE - 1)) == 0 && (size & (PAGE_SIZE - 1)) == 0);
+
+		std::size_t first = addr >> PAGE_SHIFT;
+		std::size_t last = first + (size >> PAGE_SHIFT);
+
+		for (std::size_t index = first; index < last; ++index, data += PAGE_SIZE)
+		{
+			bool writable = mode == address::access_mode::READ_WRITE;
+
+			layout_[index] = page{ data, writable ? data : nullptr, nullptr, nullptr, nullptr };
+		}
+	}
+
+	void mmu::assign(std::uint16_t addr, std::size_t size, read_handler on_read, write_handler on_write, void* context)
+	{
+		assert((addr & (PAGE_SIZE - 1)) == 0 && (size & (PAGE_SIZE - 1)) == 0);
+
+		std::size_t first = addr >> PAGE_SHIFT;
+		std::size_t last = first + (size >> PAGE_SHIFT);
+
+		for (std::size_t index = first; index < last; ++index)
+			layout_[index] = page{ nullptr, nullptr, on_read, on_write, context };
+	}
+
+	void mmu::commit(std::uint16_t addr, std::size_t size)
+	{
+		std::size_t first = addr >> PAGE_SHIFT;
+		std::size_t count = size >> PAGE_SHIFT;
+
+		for (std::size_t index = first; index < first + count; ++index)
+			set_page(index, layout_[index]);
+	}
+
+	void mmu::map_cartridge()
+	{
+		bool booted = get_origin(0).read_ != bootstrap_.data();
+		auto& data = cartridge_.get_data();
+
+		if (data.empty())
+		{
+			assign(0x0100, 0x7f00, &mmu::read_open_bus, nullptr, this);
+		}
+		else
+		{
+			std::size_t size = std::max<std::size_t>(data.size(), 0x8000);
+			data.resize((size + PAGE_SIZE - 1) & ~std::size_t{ PAGE_SIZE - 1 }, 0xff);
+
+			assign(0x0100, 0x7f00, data.data() + 0x0100, address::access_mode::READ_ONLY);
+		}
+
+		commit(0x0100, 0x7f00);
+
+		if (booted)
+			disable_bootstrap();
 	}
 
-	void mmu::disable_bootstrap(std::uint8_t value)
+	void mmu::map_external_ram()
 	{
-		std::uint16_t addr = 0x0000;
-		std::uint8_t* data = nullptr;
+		std::size_t size = std::min<std::size_t>(external_ram_.get_size(), 0x2000) & ~std::size_t{ PAGE_SIZE - 1 };
+		std::uint8_t* data = external_ram_.get_data();
+
+		assign(0xa000, 0x2000, &mmu::read_open_bus, nullptr, this);
+
+		if (size && external_ram_.is_mapped())
+		{
+			assign(0xa000, size, data, address::access_mode::READ_ONLY);
+
+			for (std::size_t index = 0xa0; index < 0xa0 + (size >> PAGE_SHIFT); ++index)
+			{
+				layout_[index].on_write_ = &mmu::write_external_ram;
+				layout_[index].context_ = this;
+			}
+		}
+		else if (size)
+		{
+			assign(0xa000, size, data, address::access_mode::READ_WRITE);
+		}
 
-		addr = 0x0000;
-		data = cartridge_.get_data().data();
-		while (addr < 0x7fff)
-			memory_[addr++].set(data++, address::access_mode::READ_ONLY);
+		commit(0xa000, 0x2000);
 	}
 
 	buffer mmu::get_bootstrap() const
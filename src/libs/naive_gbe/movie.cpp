@@ -0,0 +1,214 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/movie.hpp>
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		// Header fields are little-endian and run lengths are LEB128, so an idle stretch costs two or three bytes.
+		void put(std::vector<std::uint8_t>& out, std::uint64_t value, std::size_t size)
+		{
+			for (std::size_t byte = 0; byte < size; ++byte)
+				out.push_back(static_cast<std::uint8_t>(value >> (byte * 8)));
+		}
+
+		void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value)
+		{
+			do
+			{
+				std::uint8_t byte = value & 0x7f;
+				value >>= 7;
+				out.push_back(value ? byte | 0x80 : byte);
+			}
+			while (value);
+		}
+
+		bool get(std::vector<std::uint8_t> const& in, std::size_t& pos, std::uint64_t& value, std::size_t size)
+		{
+			if (in.size() - pos < size)
+				return false;
+
+			value = 0;
+
+			for (std::size_t byte = 0; byte < size; ++byte)
+				value |= static_cast<std::uint64_t>(in[pos++]) << (byte * 8);
+
+			return true;
+		}
+
+		bool get_varint(std::vector<std::uint8_t> const& in, std::size_t& pos, std::uint64_t& value)
+		{
+			value = 0;
+
+			for (std::size_t shift = 0; shift < 64 && pos < in.size(); shift += 7)
+			{
+				std::uint8_t byte = in[pos++];
+				value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+				if (!(byte & 0x80))
+					return true;
+			}
+
+			return false;
+		}
+	}
+
+	void movie::clear(anchor const& anchor)
+	{
+		anchor_ = anchor;
+		result_ = {};
+		runs_.clear();
+		num_frames_ = 0;
+	}
+
+	movie::anchor const& movie::get_anchor() const
+	{
+		return anchor_;
+	}
+
+	void movie::append(std::uint8_t input)
+	{
+		if (runs_.empty() || runs_.back().input_ != input)
+			runs_.push_back({ input, 0 });
+
+		++runs_.back().length_;
+		++num_frames_;
+	}
+
+	bool movie::next(cursor& cursor, std::uint8_t& input) const
+	{
+		if (cursor.run_ >= runs_.size())
+			return false;
+
+		input = runs_[cursor.run_].input_;
+
+		if (++cursor.offset_ == runs_[cursor.run_].length_)
+		{
+			++cursor.run_;
+			cursor.offset_ = 0;
+		}
+
+		return true;
+	}
+
+	std::uint64_t movie::get_num_frames() const
+	{
+		return num_frames_;
+	}
+
+	movie::input_runs const& movie::get_runs() const
+	{
+		return runs_;
+	}
+
+	void movie::set_result(result const& result)
+	{
+		result_ = result;
+	}
+
+	movie::result const& movie::get_result() const
+	{
+		return result_;
+	}
+
+	bool movie::save(std::string const& file_name, std::error_code& ec) const
+	{
+		std::vector<std::uint8_t> data;
+
+		put(data, MAGIC, 4);
+		put(data, VERSION, 2);
+		put(data, anchor_.type_, 2);
+		put(data, anchor_.boot_hash_, 8);
+		put(data, anchor_.rom_hash_, 8);
+		put(data, anchor_.ram_hash_, 8);
+		put(data, result_.cycle_, 8);
+		put(data, result_.frame_hash_, 8);
+		put(data, num_frames_, 8);
+		put(data, runs_.size(), 8);
+
+		for (auto const& run : runs_)
+		{
+			data.push_back(run.input_);
+			put_varint(data, run.length_);
+		}
+
+		std::ofstream ofs(file_name, std::ios::binary);
+
+		if (!ofs || !ofs.write(reinterpret_cast<char const*>(data.data()), data.size()))
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		return true;
+	}
+
+	bool movie::load(std::string const& file_name, std::error_code& ec)
+	{
+		std::ifstream ifs(file_name, std::ios::binary);
+
+		if (!ifs)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		std::vector<std::uint8_t> data{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+		std::size_t pos = 0;
+		std::uint64_t magic, version, type, num_frames, num_runs;
+		anchor anchor;
+		result result;
+
+		bool valid = get(data, pos, magic, 4) && magic == MAGIC
+			&& get(data, pos, version, 2) && version == VERSION
+			&& get(data, pos, type, 2) && type == ANCHOR_POWER_ON
+			&& get(data, pos, anchor.boot_hash_, 8)
+			&& get(data, pos, anchor.rom_hash_, 8)
+			&& get(data, pos, anchor.ram_hash_, 8)
+			&& get(data, pos, result.cycle_, 8)
+			&& get(data, pos, result.frame_hash_, 8)
+			&& get(data, pos, num_frames, 8)
+			&& get(data, pos, num_runs, 8)
+			&& num_runs <= data.size() - pos;
+
+		input_runs runs;
+		std::uint64_t total = 0;
+
+		for (std::uint64_t index = 0; valid && index < num_runs; ++index)
+		{
+			std::uint64_t input = 0;
+			input_run run;
+
+			valid = get(data, pos, input, 1) && get_varint(data, pos, run.length_) && run.length_;
+
+			if (!valid)
+				break;
+
+			run.input_ = static_cast<std::uint8_t>(input);
+			total += run.length_;
+			runs.push_back(run);
+		}
+
+		if (!valid || pos != data.size() || total != num_frames)
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		anchor_ = anchor;
+		result_ = result;
+		runs_ = std::move(runs);
+		num_frames_ = num_frames;
+
+		return true;
+	}
+}
@@ -0,0 +1,334 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/pixel_kernels.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define NAIVE_GBE_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define NAIVE_GBE_X86 0
+#endif
+
+#if defined(__GNUC__)
+	#define NAIVE_GBE_TARGET(name) __attribute__((target(name)))
+#else
+	#define NAIVE_GBE_TARGET(name)
+#endif
+
+namespace naive_gbe
+{
+	namespace
+	{
+		void decode_scalar(std::uint8_t const* data, std::size_t rows, std::uint8_t* out)
+		{
+			for (std::size_t row = 0; row < rows; ++row, data += 2)
+			{
+				std::uint8_t lo = data[0];
+				std::uint8_t hi = data[1];
+
+				for (int bit = 7; bit >= 0; --bit)
+					*out++ = ((lo >> bit) & 1) | (((hi >> bit) & 1) << 1);
+			}
+		}
+
+		void map_scalar(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out)
+		{
+			std::uint8_t shades[4] =
+			{
+				static_cast<std::uint8_t>(palette & 0x03),
+				static_cast<std::uint8_t>((palette >> 2) & 0x03),
+				static_cast<std::uint8_t>((palette >> 4) & 0x03),
+				static_cast<std::uint8_t>((palette >> 6) & 0x03),
+			};
+
+			for (std::size_t i = 0; i < count; ++i)
+				out[i] = shades[colors[i] & 0x03];
+		}
+
+		void expand_scalar(std::uint8_t const* shades, std::size_t count, pixel_kernels::rgba_palette const& palette, std::uint32_t* out)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				out[i] = palette[shades[i] & 0x03];
+		}
+
+#if NAIVE_GBE_X86
+		NAIVE_GBE_TARGET("sse2")
+		void decode_sse2(std::uint8_t const* data, std::size_t rows, std::uint8_t* out)
+		{
+			const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const __m128i one = _mm_set1_epi8(1);
+			const __m128i two = _mm_set1_epi8(2);
+
+			std::size_t row = 0;
+
+			for (; row + 2 <= rows; row += 2)
+			{
+				std::uint8_t const* src = data + row * 2;
+
+				__m128i lo = _mm_cvtsi32_si128(src[0] | src[2] << 8);
+				__m128i hi = _mm_cvtsi32_si128(src[1] | src[3] << 8);
+
+				lo = _mm_unpacklo_epi8(lo, lo);
+				lo = _mm_unpacklo_epi16(lo, lo);
+				lo = _mm_unpacklo_epi32(lo, lo);
+				hi = _mm_unpacklo_epi8(hi, hi);
+				hi = _mm_unpacklo_epi16(hi, hi);
+				hi = _mm_unpacklo_epi32(hi, hi);
+
+				lo = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo, bits), bits), one);
+				hi = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi, bits), bits), two);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + row * 8), _mm_or_si128(lo, hi));
+			}
+
+			decode_scalar(data + row * 2, rows - row, out + row * 8);
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		void map_sse2(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out)
+		{
+			const __m128i mask = _mm_set1_epi8(0x03);
+			__m128i keys[4];
+			__m128i shades[4];
+
+			for (int color = 0; color < 4; ++color)
+			{
+				keys[color] = _mm_set1_epi8(static_cast<char>(color));
+				shades[color] = _mm_set1_epi8(static_cast<char>((palette >> (color * 2)) & 0x03));
+			}
+
+			std::size_t i = 0;
+
+			for (; i + 16 <= count; i += 16)
+			{
+				__m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(colors + i)), mask);
+				__m128i r = _mm_setzero_si128();
+
+				for (int color = 0; color < 4; ++color)
+					r = _mm_or_si128(r, _mm_and_si128(_mm_cmpeq_epi8(c, keys[color]), shades[color]));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+			}
+
+			map_scalar(colors + i, count - i, palette, out + i);
+		}
+
+		NAIVE_GBE_TARGET("sse2")
+		void expand_sse2(std::uint8_t const* shades, std::size_t count, pixel_kernels::rgba_palette const& palette, std::uint32_t* out)
+		{
+			const __m128i mask = _mm_set1_epi8(0x03);
+			__m128i keys[4];
+			__m128i colors[4];
+
+			for (int shade = 0; shade < 4; ++shade)
+			{
+				keys[shade] = _mm_set1_epi8(static_cast<char>(shade));
+				colors[shade] = _mm_set1_epi32(static_cast<int>(palette[shade]));
+			}
+
+			std::size_t i = 0;
+
+			for (; i + 16 <= count; i += 16)
+			{
+				__m128i s = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(shades + i)), mask);
+				__m128i r[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+
+				for (int shade = 0; shade < 4; ++shade)
+				{
+					__m128i m = _mm_cmpeq_epi8(s, keys[shade]);
+					__m128i lo = _mm_unpacklo_epi8(m, m);
+					__m128i hi = _mm_unpackhi_epi8(m, m);
+
+					r[0] = _mm_or_si128(r[0], _mm_and_si128(_mm_unpacklo_epi16(lo, lo), colors[shade]));
+					r[1] = _mm_or_si128(r[1], _mm_and_si128(_mm_unpackhi_epi16(lo, lo), colors[shade]));
+					r[2] = _mm_or_si128(r[2], _mm_and_si128(_mm_unpacklo_epi16(hi, hi), colors[shade]));
+					r[3] = _mm_or_si128(r[3], _mm_and_si128(_mm_unpackhi_epi16(hi, hi), colors[shade]));
+				}
+
+				for (int quarter = 0; quarter < 4; ++quarter)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + quarter * 4), r[quarter]);
+			}
+
+			expand_scalar(shades + i, count - i, palette, out + i);
+		}
+
+		NAIVE_GBE_TARGET("avx2")
+		void decode_avx2(std::uint8_t const* data, std::size_t rows, std::uint8_t* out)
+		{
+			const __m256i bits = _mm256_setr_epi8(
+				-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1,
+				-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+			const __m256i select_lo = _mm256_setr_epi8(
+				0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2,
+				4, 4, 4, 4, 4, 4, 4, 4, 6, 6, 6, 6, 6, 6, 6, 6);
+			const __m256i select_hi = _mm256_setr_epi8(
+				1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3, 3, 3,
+				5, 5, 5, 5, 5, 5, 5, 5, 7, 7, 7, 7, 7, 7, 7, 7);
+			const __m256i one = _mm256_set1_epi8(1);
+			const __m256i two = _mm256_set1_epi8(2);
+
+			std::size_t row = 0;
+
+			for (; row + 4 <= rows; row += 4)
+			{
+				__m128i src = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(data + row * 2));
+				__m256i both = _mm256_broadcastsi128_si256(src);
+
+				__m256i lo = _mm256_shuffle_epi8(both, select_lo);
+				__m256i hi = _mm256_shuffle_epi8(both, select_hi);
+
+				lo = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(lo, bits), bits), one);
+				hi = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(hi, bits), bits), two);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + row * 8), _mm256_or_si256(lo, hi));
+			}
+
+			decode_sse2(data + row * 2, rows - row, out + row * 8);
+		}
+
+		NAIVE_GBE_TARGET("avx2")
+		void map_avx2(std::uint8_t const* colors, std::size_t count, std::uint8_t palette, std::uint8_t* out)
+		{
+			const __m256i mask = _mm256_set1_epi8(0x03);
+			char s0 = palette & 0x03;
+			char s1 = (palette >> 2) & 0x03;
+			char s2 = (palette >> 4) & 0x03;
+			char s3 = (palette >> 6) & 0x03;
+
+			const __m256i lut = _mm256_setr_epi8(
+				s0, s1, s2, s3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+				s0, s1, s2, s3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+			std::size_t i = 0;
+
+			for (; i + 32 <= count; i += 32)
+			{
+				__m256i c = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(colors + i)), mask);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(lut, c));
+			}
+
+			map_sse2(colors + i, count - i, palette, out + i);
+		}
+
+		NAIVE_GBE_TARGET("avx2")
+		void expand_avx2(std::uint8_t const* shades, std::size_t count, pixel_kernels::rgba_palette const& palette, std::uint32_t* out)
+		{
+			const __m256i mask = _mm256_set1_epi32(0x03);
+			const __m256i colors = _mm256_setr_epi32(
+				static_cast<int>(palette[0]), static_cast<int>(palette[1]),
+				static_cast<int>(palette[2]), static_cast<int>(palette[3]),
+				static_cast<int>(palette[0]), static_cast<int>(palette[1]),
+				static_cast<int>(palette[2]), static_cast<int>(palette[3]));
+
+			std::size_t i = 0;
+
+			for (; i + 16 <= count; i += 16)
+			{
+				__m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(shades + i)));
+				__m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(shades + i + 8)));
+
+				lo = _mm256_permutevar8x32_epi32(colors, _mm256_and_si256(lo, mask));
+				hi = _mm256_permutevar8x32_epi32(colors, _mm256_and_si256(hi, mask));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), lo);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), hi);
+			}
+
+			expand_sse2(shades + i, count - i, palette, out + i);
+		}
+
+		bool has_sse2()
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			return (info[3] & (1 << 26)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse2");
+#endif
+		}
+
+		bool has_avx2()
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+
+			if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x06) != 0x06)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+	}
+
+	pixel_kernels::pixel_kernels()
+		: pixel_kernels(isa::AVX2)
+	{
+	}
+
+	pixel_kernels::pixel_kernels(isa isa)
+	{
+		while (!is_supported(isa))
+			isa = static_cast<pixel_kernels::isa>(static_cast<std::uint8_t>(isa) - 1);
+
+		isa_ = isa;
+
+		switch (isa)
+		{
+#if NAIVE_GBE_X86
+		case isa::AVX2:
+			decode_ = &decode_avx2;
+			map_ = &map_avx2;
+			expand_ = &expand_avx2;
+			break;
+		case isa::SSE2:
+			decode_ = &decode_sse2;
+			map_ = &map_sse2;
+			expand_ = &expand_sse2;
+			break;
+#endif
+		default:
+			decode_ = &decode_scalar;
+			map_ = &map_scalar;
+			expand_ = &expand_scalar;
+			break;
+		}
+	}
+
+	pixel_kernels::isa pixel_kernels::get_isa() const
+	{
+		return isa_;
+	}
+
+	bool pixel_kernels::is_supported(isa isa)
+	{
+		switch (isa)
+		{
+		case isa::SCALAR:
+			return true;
+#if NAIVE_GBE_X86
+		case isa::SSE2:
+			return has_sse2();
+		case isa::AVX2:
+			return has_sse2() && has_avx2();
+#endif
+		default:
+			return false;
+		}
+	}
+}
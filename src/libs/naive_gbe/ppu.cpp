@@ -5,27 +5,69 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 //
 #include <naive_gbe/ppu.hpp>
+#include <naive_gbe/hash.hpp>
 
-#include <random>
+#include <algorithm>
 
 namespace naive_gbe
 {
+	namespace
+	{
+		template <typename T>
+		bool has_flag(std::uint8_t value, T flag)
+		{
+			return (value & static_cast<std::uint8_t>(flag)) != 0;
+		}
+
+		std::size_t get_tile_offset(std::uint8_t index, bool unsigned_mode)
+		{
+			return unsigned_mode ? index * 16u : 0x1000 + static_cast<std::int8_t>(index) * 16;
+		}
+
+		std::uint8_t get_shade(std::uint8_t palette, std::uint8_t color)
+		{
+			return (palette >> (color * 2)) & 0x03;
+		}
+	}
+
 	ppu::ppu(mmu& mmu)
 		: mmu_(mmu)
 	{
 		auto screen = get_screen();
 
 		vram_.assign(screen.width * screen.height, 0);
-		write_to_video_ram();
+
+		mmu_.set_sync_handler(&ppu::sync, this);
+		mmu_.set_io_handler(IO_REG_LCDC, &ppu::write_lcdc, this);
+		mmu_.set_io_handler(IO_REG_LCDS, &ppu::write_stat, this);
+		mmu_.set_io_handler(IO_REG_LY, &ppu::write_ly, this);
+		mmu_.set_video_ram_handler(&ppu::write_video_ram, this);
+		mmu_.set_oam_handler(&ppu::write_oam, this);
+
+		stale_.fill(true);
 	}
 
-	void ppu::write_to_video_ram()
+	void ppu::reset()
 	{
-		std::mt19937 urng{ std::random_device{}() };
-		std::uniform_int_distribution<int> dist(0, 3);
+		std::fill(vram_.begin(), vram_.end(), 0);
+		std::fill(rgba_.begin(), rgba_.end(), palette_[0]);
+		stale_.fill(true);
+		buckets_stale_ = true;
+		num_pending_ = 0;
+		invalidate_lines();
+
+		cycle_ = 0;
+		next_ = 0;
+		frame_ = 0;
+		enabled_ = false;
+		mode_ = MODE_HBLANK;
+		line_index_ = 0;
+		window_line_ = 0;
+		lines_skipped_ = 0;
+		last_skipped_ = 0;
+		++version_;
 
-		for (auto& pixel : vram_)
-			pixel = dist(urng);
+		mmu_.get_scheduler().cancel(scheduler::EVENT_PPU);
 	}
 
 	ppu::video_ram const& ppu::get_video_ram() const
@@ -33,11 +75,68 @@ namespace naive_gbe
 		return vram_;
 	}
 
+	ppu::rgba_buffer const& ppu::get_rgba_buffer() const
+	{
+		return rgba_;
+	}
+
+	std::uint64_t ppu::get_frame_hash() const
+	{
+		return hash64(vram_.data(), vram_.size());
+	}
+
+	void ppu::set_output(output_format format, rgba_palette const& palette)
+	{
+		output_ = format;
+		palette_ = palette;
+
+		if (format == OUTPUT_RGBA32)
+		{
+			rgba_.resize(vram_.size());
+			kernels_.expand(vram_.data(), vram_.size(), palette_, rgba_.data());
+		}
+		else
+		{
+			rgba_.clear();
+		}
+
+		++version_;
+	}
+
+	ppu::output_format ppu::get_output_format() const
+	{
+		return output_;
+	}
+
+	frame_exchange& ppu::get_frames()
+	{
+		return frames_;
+	}
+
+	void ppu::set_frame_handler(frame_handler handler, void* context)
+	{
+		on_frame_ = handler;
+		frame_context_ = context;
+	}
+
 	void ppu::run(std::size_t cycle)
 	{
-		cycle_ = cycle % CYCLES_PER_SECOND;
+		bool enabled = has_flag(mmu_.get_io(IO_REG_LCDC), lcd_control::LCD_DISP_ENABLE);
+
+		if (enabled != enabled_)
+		{
+			if (enabled)
+				enable(cycle);
+			else
+				disable();
+		}
+
+		cycle_ = cycle;
+
+		while (enabled_ && cycle_ >= next_)
+			advance();
 
-		mmu_[IO_REG_LY] = static_cast<std::uint8_t>(cycle_ / CYCLES_PER_HBLANK) % NUM_SCAN_LINES;
+		schedule();
 	}
 
 	std::size_t ppu::get_cycle() const
@@ -45,28 +144,690 @@ namespace naive_gbe
 		return cycle_;
 	}
 
+	std::size_t ppu::get_frame() const
+	{
+		return frame_;
+	}
+
+	ppu::mode ppu::get_mode() const
+	{
+		return mode_;
+	}
+
+	std::uint8_t ppu::get_line() const
+	{
+		return line_index_;
+	}
+
+	std::size_t ppu::get_lines_skipped() const
+	{
+		return last_skipped_;
+	}
+
+	std::size_t ppu::get_version() const
+	{
+		return version_;
+	}
+
+	void ppu::set_render_mode(render_mode mode, std::size_t interval)
+	{
+		render_mode_ = mode;
+		interval_ = std::max<std::size_t>(interval, 1);
+	}
+
+	ppu::render_mode ppu::get_render_mode() const
+	{
+		return render_mode_;
+	}
+
+	std::size_t ppu::get_render_interval() const
+	{
+		return interval_;
+	}
+
+	void ppu::set_raster_threads(std::size_t count)
+	{
+		flush_lines();
+
+		if (count)
+			workers_ = std::make_unique<worker_pool>(count);
+		else
+			workers_.reset();
+	}
+
+	std::size_t ppu::get_raster_threads() const
+	{
+		return workers_ ? workers_->get_num_threads() : 0;
+	}
+
+	void ppu::sync(void* context, std::uint16_t addr)
+	{
+		auto self = static_cast<ppu*>(context);
+		std::size_t cycle = self->mmu_.get_scheduler().get_cycle();
+
+		if (cycle > self->cycle_)
+			self->run(cycle);
+
+		if (addr < 0xff00)
+			self->flush_lines();
+	}
+
+	void ppu::on_event(void* context, std::uint64_t cycle)
+	{
+		auto self = static_cast<ppu*>(context);
+
+		self->run(self->mmu_.get_scheduler().get_cycle());
+	}
+
+	void ppu::write_lcdc(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<ppu*>(context);
+		auto& scheduler = self->mmu_.get_scheduler();
+
+		if (has_flag(value, lcd_control::LCD_DISP_ENABLE) != self->enabled_)
+			scheduler.schedule(scheduler::EVENT_PPU, scheduler.get_cycle() + 1, &ppu::on_event, self);
+	}
+
+	void ppu::write_stat(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<ppu*>(context);
+		std::uint8_t status = self->mmu_.get_io(IO_REG_LCDS);
+
+		self->mmu_.set_io(IO_REG_LCDS, 0x80 | (value & 0x78) | (status & 0x07));
+		self->schedule();
+	}
+
+	void ppu::write_ly(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<ppu*>(context);
+
+		self->mmu_.set_io(IO_REG_LY, self->line_index_);
+	}
+
+	void ppu::write_video_ram(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<ppu*>(context);
+		std::size_t offset = addr - 0x8000u;
+
+		if (offset < NUM_TILES * TILE_SIZE)
+		{
+			self->stale_[offset / TILE_SIZE] = true;
+			self->tile_stamps_[offset / TILE_SIZE] = ++self->generation_;
+		}
+		else
+		{
+			self->map_stamps_[(offset - NUM_TILES * TILE_SIZE) / 32] = ++self->generation_;
+		}
+	}
+
+	void ppu::write_oam(void* context, std::uint16_t addr, std::uint8_t value)
+	{
+		auto self = static_cast<ppu*>(context);
+		std::size_t offset = addr - 0xfe00u;
+
+		if (offset < NUM_SPRITES * 4)
+		{
+			self->oam_stamps_[offset / 4] = ++self->generation_;
+
+			if ((offset & 3) < 2)
+				self->buckets_stale_ = true;
+		}
+	}
+
+	std::uint8_t const* ppu::get_tile(std::size_t offset)
+	{
+		std::size_t index = offset / TILE_SIZE;
+		std::uint8_t* tile = &tiles_[index * TILE_PIXELS];
+
+		if (stale_[index])
+		{
+			kernels_.decode(mmu_.get_video_ram() + index * TILE_SIZE, 8, tile);
+			stale_[index] = false;
+		}
+
+		return tile;
+	}
+
+	void ppu::invalidate_lines()
+	{
+		for (auto& signature : signatures_)
+			signature.valid_ = false;
+
+		++version_;
+	}
+
+	void ppu::enable(std::size_t cycle)
+	{
+		enabled_ = true;
+		next_ = cycle + CYCLES_PER_OAM_SCAN;
+		window_line_ = 0;
+
+		set_line(0);
+		set_mode(MODE_OAM_SCAN);
+	}
+
+	void ppu::disable()
+	{
+		enabled_ = false;
+		window_line_ = 0;
+		num_pending_ = 0;
+
+		std::fill(vram_.begin(), vram_.end(), 0);
+		std::fill(rgba_.begin(), rgba_.end(), palette_[0]);
+		invalidate_lines();
+		publish_frame();
+
+		set_line(0);
+		set_mode(MODE_HBLANK);
+	}
+
+	void ppu::advance()
+	{
+		switch (mode_)
+		{
+		case MODE_OAM_SCAN:
+			next_ += CYCLES_PER_TRANSFER;
+			set_mode(MODE_TRANSFER);
+			break;
+
+		case MODE_TRANSFER:
+			if (is_rendering())
+				render_line();
+			next_ += CYCLES_PER_HBLANK;
+			set_mode(MODE_HBLANK);
+			break;
+
+		case MODE_HBLANK:
+			set_line(line_index_ + 1);
+
+			if (line_index_ == SCREEN_HEIGHT)
+			{
+				next_ += CYCLES_PER_LINE;
+				++frame_;
+				last_skipped_ = lines_skipped_;
+				lines_skipped_ = 0;
+				set_mode(MODE_VBLANK);
+				mmu_.request_interrupt(mmu::INT_VBLANK);
+				flush_lines();
+				publish_frame();
+
+				if (on_frame_)
+					on_frame_(frame_context_, vram_.data(), frame_);
+			}
+			else
+			{
+				next_ += CYCLES_PER_OAM_SCAN;
+				set_mode(MODE_OAM_SCAN);
+			}
+			break;
+
+		case MODE_VBLANK:
+			if (line_index_ + 1 == NUM_SCAN_LINES)
+			{
+				next_ += CYCLES_PER_OAM_SCAN;
+				window_line_ = 0;
+				set_line(0);
+				set_mode(MODE_OAM_SCAN);
+			}
+			else
+			{
+				next_ += CYCLES_PER_LINE;
+				set_line(line_index_ + 1);
+			}
+			break;
+		}
+	}
+
+	void ppu::schedule()
+	{
+		auto& scheduler = mmu_.get_scheduler();
+
+		if (!enabled_)
+		{
+			scheduler.cancel(scheduler::EVENT_PPU);
+			return;
+		}
+
+		std::uint8_t sources = static_cast<std::uint8_t>(lcd_status::COINCIDENCE_INTERRUPT) |
+			static_cast<std::uint8_t>(lcd_status::MODE_2_OAM_INTERRUPT) |
+			static_cast<std::uint8_t>(lcd_status::MODE_1_VBLANK_INTERRUPT) |
+			static_cast<std::uint8_t>(lcd_status::MODE_0_HBLANK_INTERRUPT);
+
+		std::size_t cycle = (mmu_.get_io(IO_REG_LCDS) & sources) ? next_ : get_frame_end();
+
+		if (scheduler.get_event_cycle(scheduler::EVENT_PPU) != cycle)
+			scheduler.schedule(scheduler::EVENT_PPU, cycle, &ppu::on_event, this);
+	}
+
+	std::size_t ppu::get_frame_end() const
+	{
+		std::size_t line_start = next_;
+
+		switch (mode_)
+		{
+		case MODE_OAM_SCAN:
+			line_start -= CYCLES_PER_OAM_SCAN;
+			break;
+		case MODE_TRANSFER:
+			line_start -= CYCLES_PER_OAM_SCAN + CYCLES_PER_TRANSFER;
+			break;
+		default:
+			line_start -= CYCLES_PER_LINE;
+			break;
+		}
+
+		std::size_t lines = line_index_ < SCREEN_HEIGHT ?
+			SCREEN_HEIGHT - line_index_ :
+			NUM_SCAN_LINES - line_index_ + SCREEN_HEIGHT;
+
+		return line_start + lines * CYCLES_PER_LINE;
+	}
+
+	void ppu::set_mode(mode mode)
+	{
+		std::uint8_t status = mmu_.get_io(IO_REG_LCDS);
+
+		mode_ = mode;
+		mmu_.set_io(IO_REG_LCDS, (status & ~static_cast<std::uint8_t>(lcd_status::MODE_FLAG)) | mode);
+
+		bool request = false;
+
+		switch (mode)
+		{
+		case MODE_HBLANK:
+			request = has_flag(status, lcd_status::MODE_0_HBLANK_INTERRUPT);
+			break;
+		case MODE_VBLANK:
+			request = has_flag(status, lcd_status::MODE_1_VBLANK_INTERRUPT);
+			break;
+		case MODE_OAM_SCAN:
+			request = has_flag(status, lcd_status::MODE_2_OAM_INTERRUPT);
+			break;
+		default:
+			break;
+		}
+
+		if (request && enabled_)
+			mmu_.request_interrupt(mmu::INT_LCD_STAT);
+	}
+
+	void ppu::set_line(std::uint8_t line)
+	{
+		std::uint8_t status = mmu_.get_io(IO_REG_LCDS);
+		std::uint8_t flag = static_cast<std::uint8_t>(lcd_status::CONICIDENCE_FLAG);
+
+		line_index_ = line;
+		mmu_.set_io(IO_REG_LY, line);
+
+		if (line != mmu_.get_io(IO_REG_LYC))
+		{
+			mmu_.set_io(IO_REG_LCDS, status & ~flag);
+			return;
+		}
+
+		mmu_.set_io(IO_REG_LCDS, status | flag);
+
+		if (enabled_ && has_flag(status, lcd_status::COINCIDENCE_INTERRUPT))
+			mmu_.request_interrupt(mmu::INT_LCD_STAT);
+	}
+
+	void ppu::build_sprite_buckets(bool tall)
+	{
+		std::uint8_t const* oam = mmu_.get_oam();
+		int height = tall ? 16 : 8;
+
+		for (auto& bucket : buckets_)
+			bucket.count_ = 0;
+
+		for (std::uint8_t index = 0; index < NUM_SPRITES; ++index)
+		{
+			int y = oam[index * 4] - 16;
+			int first = std::max(y, 0);
+			int last = std::min<int>(y + height, SCREEN_HEIGHT);
+
+			for (int line = first; line < last; ++line)
+			{
+				sprite_list& bucket = buckets_[line];
+
+				if (bucket.count_ < MAX_SPRITES_PER_LINE)
+					bucket.index_[bucket.count_++] = index;
+			}
+		}
+
+		for (auto& bucket : buckets_)
+		{
+			std::stable_sort(bucket.index_.begin(), bucket.index_.begin() + bucket.count_,
+				[oam](std::uint8_t lhs, std::uint8_t rhs) { return oam[lhs * 4 + 1] < oam[rhs * 4 + 1]; });
+		}
+
+		buckets_stale_ = false;
+		buckets_tall_ = tall;
+	}
+
+	ppu::sprite_list const& ppu::get_sprites(std::uint8_t lcdc)
+	{
+		bool tall = has_flag(lcdc, lcd_control::OBJ_SPRITE_SIZE);
+
+		if (buckets_stale_ || buckets_tall_ != tall)
+			build_sprite_buckets(tall);
+
+		return buckets_[line_index_];
+	}
+
+	std::uint64_t ppu::get_map_stamp(std::size_t map, std::uint8_t y, std::size_t first, std::size_t count, bool unsigned_mode) const
+	{
+		std::uint8_t const* vram = mmu_.get_video_ram();
+		std::size_t row = map + (y / 8) * 32;
+		std::uint64_t stamp = map_stamps_[(row - NUM_TILES * TILE_SIZE) / 32];
+
+		for (std::size_t tile = 0; tile < count; ++tile)
+		{
+			std::uint8_t index = vram[row + ((first + tile) & 31)];
+
+			stamp = std::max(stamp, tile_stamps_[get_tile_offset(index, unsigned_mode) / TILE_SIZE]);
+		}
+
+		return stamp;
+	}
+
+	std::uint64_t ppu::get_line_stamp(std::uint8_t lcdc, bool window, sprite_list const& sprites) const
+	{
+		bool unsigned_mode = has_flag(lcdc, lcd_control::BG_WND_TITLE_DATA_SEL);
+		std::uint64_t stamp = 0;
+
+		if (has_flag(lcdc, lcd_control::BG_WND_DIS_PRIORITY))
+		{
+			std::size_t map = has_flag(lcdc, lcd_control::BG_TITLE_MAP_DISP_SEL) ? 0x1c00 : 0x1800;
+			std::uint8_t y = line_index_ + mmu_.get_io(IO_REG_SCY);
+
+			stamp = get_map_stamp(map, y, mmu_.get_io(IO_REG_SCX) / 8, SCREEN_WIDTH / 8 + 1, unsigned_mode);
+		}
+
+		if (window)
+		{
+			std::size_t map = has_flag(lcdc, lcd_control::WND_TITLE_MAP_DISP_SEL) ? 0x1c00 : 0x1800;
+			int start = mmu_.get_io(IO_REG_WX) - 7;
+
+			stamp = std::max(stamp, get_map_stamp(map, window_line_, 0, (SCREEN_WIDTH - start + 7) / 8, unsigned_mode));
+		}
+
+		std::uint8_t const* oam = mmu_.get_oam();
+		bool tall = has_flag(lcdc, lcd_control::OBJ_SPRITE_SIZE);
+
+		for (std::size_t i = 0; i < sprites.count_; ++i)
+		{
+			std::uint8_t index = sprites.index_[i];
+			std::uint8_t tile = oam[index * 4 + 2];
+
+			stamp = std::max(stamp, oam_stamps_[index]);
+
+			if (tall)
+				stamp = std::max({ stamp, tile_stamps_[tile & 0xfe], tile_stamps_[tile | 0x01] });
+			else
+				stamp = std::max(stamp, tile_stamps_[tile]);
+		}
+
+		return stamp;
+	}
+
+	bool ppu::is_rendering() const
+	{
+		switch (render_mode_)
+		{
+		case RENDER_INTERVAL:
+			return frame_ % interval_ == 0;
+		case RENDER_TIMING_ONLY:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	void ppu::render_line()
+	{
+		std::uint8_t lcdc = mmu_.get_io(IO_REG_LCDC);
+		std::uint8_t wx = mmu_.get_io(IO_REG_WX);
+		std::uint8_t wy = mmu_.get_io(IO_REG_WY);
+
+		bool window = has_flag(lcdc, lcd_control::BG_WND_DIS_PRIORITY) &&
+			has_flag(lcdc, lcd_control::WND_DISP_ENABLE) &&
+			line_index_ >= wy && wx <= SCREEN_WIDTH + 6;
+
+		static sprite_list const no_sprites{};
+
+		sprite_list const& sprites = has_flag(lcdc, lcd_control::OBJ_SPRITE_DISP_ENABLE) ? get_sprites(lcdc) : no_sprites;
+
+		line_signature current;
+		current.registers_ =
+		{
+			lcdc, mmu_.get_io(IO_REG_SCX), mmu_.get_io(IO_REG_SCY), wx, wy,
+			mmu_.get_io(IO_REG_BGP), mmu_.get_io(IO_REG_OBP0), mmu_.get_io(IO_REG_OBP1),
+			window_line_,
+		};
+		current.valid_ = true;
+
+		for (std::size_t i = 0; i < sprites.count_; ++i)
+			current.sprites_ |= std::uint64_t{ 1 } << sprites.index_[i];
+
+		line_signature& cached = signatures_[line_index_];
+
+		bool unchanged = cached.valid_ &&
+			cached.registers_ == current.registers_ &&
+			cached.sprites_ == current.sprites_ &&
+			get_line_stamp(lcdc, window, sprites) <= cached.stamp_;
+
+		if (window)
+			++window_line_;
+
+		if (unchanged)
+		{
+			++lines_skipped_;
+			return;
+		}
+
+		current.stamp_ = generation_;
+		cached = current;
+		++version_;
+
+		line_state& state = pending_[num_pending_];
+		state.registers_ = current.registers_;
+		state.sprites_ = sprites;
+		state.index_ = line_index_;
+		state.window_ = window;
+
+		if (workers_)
+			++num_pending_;
+		else
+			rasterize(state, line_);
+	}
+
+	void ppu::flush_lines()
+	{
+		if (!num_pending_)
+			return;
+
+		for (std::size_t index = 0; index < NUM_TILES; ++index)
+		{
+			if (stale_[index])
+				get_tile(index * TILE_SIZE);
+		}
+
+		std::size_t count = num_pending_;
+		std::size_t chunks = std::min(workers_->get_num_threads() + 1, count);
+
+		workers_->run(chunks, [this, count, chunks](std::size_t chunk)
+		{
+			line_buffer line;
+
+			for (std::size_t index = chunk * count / chunks; index < (chunk + 1) * count / chunks; ++index)
+				rasterize(pending_[index], line);
+		});
+
+		num_pending_ = 0;
+	}
+
+	void ppu::publish_frame()
+	{
+		if (published_ == version_)
+			return;
+
+		auto& frame = frames_.get_back();
+
+		frame.shades_ = vram_;
+		frame.rgba_ = rgba_;
+		frame.number_ = frame_;
+
+		frames_.publish();
+		published_ = version_;
+	}
+
+	void ppu::rasterize(line_state const& state, line_buffer& line)
+	{
+		std::uint8_t lcdc = state.registers_[LINE_LCDC];
+		std::uint8_t* out = &vram_[state.index_ * SCREEN_WIDTH];
+
+		if (has_flag(lcdc, lcd_control::BG_WND_DIS_PRIORITY))
+		{
+			render_background(state, line);
+
+			if (state.window_)
+				render_window(state, line);
+
+			kernels_.map(line.data(), SCREEN_WIDTH, state.registers_[LINE_BGP], out);
+		}
+		else
+		{
+			std::fill_n(line.begin(), SCREEN_WIDTH, 0);
+			std::fill_n(out, SCREEN_WIDTH, 0);
+		}
+
+		render_sprites(state, line, out);
+
+		if (output_ == OUTPUT_RGBA32)
+			kernels_.expand(out, SCREEN_WIDTH, palette_, &rgba_[state.index_ * SCREEN_WIDTH]);
+	}
+
+	void ppu::render_background(line_state const& state, line_buffer& line)
+	{
+		std::uint8_t const* vram = mmu_.get_video_ram();
+		std::uint8_t lcdc = state.registers_[LINE_LCDC];
+		std::uint8_t scx = state.registers_[LINE_SCX];
+		std::uint8_t y = state.index_ + state.registers_[LINE_SCY];
+
+		std::size_t map = has_flag(lcdc, lcd_control::BG_TITLE_MAP_DISP_SEL) ? 0x1c00 : 0x1800;
+		std::size_t row = map + (y / 8) * 32;
+		bool unsigned_mode = has_flag(lcdc, lcd_control::BG_WND_TITLE_DATA_SEL);
+
+		std::array<std::uint8_t, SCREEN_WIDTH + 16> pixels;
+
+		for (std::size_t tile = 0; tile <= SCREEN_WIDTH / 8; ++tile)
+		{
+			std::uint8_t index = vram[row + ((scx / 8 + tile) & 31)];
+
+			std::copy_n(get_tile(get_tile_offset(index, unsigned_mode)) + (y & 7) * 8, 8, &pixels[tile * 8]);
+		}
+
+		std::copy_n(pixels.begin() + (scx & 7), SCREEN_WIDTH, line.begin());
+	}
+
+	void ppu::render_window(line_state const& state, line_buffer& line)
+	{
+		std::uint8_t const* vram = mmu_.get_video_ram();
+		std::uint8_t lcdc = state.registers_[LINE_LCDC];
+		std::uint8_t y = state.registers_[LINE_WINDOW];
+		int start = state.registers_[LINE_WX] - 7;
+		int width = SCREEN_WIDTH;
+
+		std::size_t map = has_flag(lcdc, lcd_control::WND_TITLE_MAP_DISP_SEL) ? 0x1c00 : 0x1800;
+		std::size_t row = map + (y / 8) * 32;
+		bool unsigned_mode = has_flag(lcdc, lcd_control::BG_WND_TITLE_DATA_SEL);
+
+		std::array<std::uint8_t, SCREEN_WIDTH + 16> pixels;
+		std::size_t tiles = (SCREEN_WIDTH - start + 7) / 8;
+
+		for (std::size_t tile = 0; tile < tiles; ++tile)
+		{
+			std::uint8_t index = vram[row + tile];
+
+			std::copy_n(get_tile(get_tile_offset(index, unsigned_mode)) + (y & 7) * 8, 8, &pixels[tile * 8]);
+		}
+
+		for (int x = std::max(start, 0); x < width; ++x)
+			line[x] = pixels[x - start];
+	}
+
+	void ppu::render_sprites(line_state const& state, line_buffer const& line, std::uint8_t* out)
+	{
+		std::uint8_t const* oam = mmu_.get_oam();
+		sprite_list const& sprites = state.sprites_;
+		int height = has_flag(state.registers_[LINE_LCDC], lcd_control::OBJ_SPRITE_SIZE) ? 16 : 8;
+		int width = SCREEN_WIDTH;
+
+		std::array<bool, SCREEN_WIDTH> taken = {};
+
+		for (std::size_t i = 0; i < sprites.count_; ++i)
+		{
+			std::uint8_t const* sprite = oam + sprites.index_[i] * 4;
+			std::uint8_t attributes = sprite[3];
+			std::uint8_t tile = sprite[2];
+			int row = state.index_ - (sprite[0] - 16);
+			int left = sprite[1] - 8;
+
+			if (has_flag(attributes, SPRITE_Y_FLIP))
+				row = height - 1 - row;
+
+			if (height == 16)
+				tile &= 0xfe;
+
+			std::array<std::uint8_t, 8> pixels;
+			std::uint8_t const* data = get_tile(tile * TILE_SIZE + (row / 8) * TILE_SIZE) + (row & 7) * 8;
+
+			if (has_flag(attributes, SPRITE_X_FLIP))
+				std::reverse_copy(data, data + 8, pixels.begin());
+			else
+				std::copy_n(data, 8, pixels.begin());
+
+			std::uint8_t palette = state.registers_[has_flag(attributes, SPRITE_PALETTE) ? LINE_OBP1 : LINE_OBP0];
+
+			for (int offset = 0; offset < 8; ++offset)
+			{
+				int x = left + offset;
+
+				if (x < 0 || x >= width || taken[x] || !pixels[offset])
+					continue;
+
+				taken[x] = true;
+
+				if (has_flag(attributes, SPRITE_BEHIND_BG) && line[x])
+					continue;
+
+				out[x] = get_shade(palette, pixels[offset]);
+			}
+		}
+	}
+
 	ppu::rect ppu::get_window() const
 	{
-		return rect{ static_cast<std::uint16_t>(mmu_[IO_REG_WX] + 7), mmu_[IO_REG_WY], 160, 144 };
+		return rect{ 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
 	}
 
 	std::uint16_t ppu::get_screen_width() const
 	{
-		return 160;
+		return SCREEN_WIDTH;
 	}
 
 	std::uint16_t ppu::get_screen_height() const
 	{
-		return 144;
+		return SCREEN_HEIGHT;
 	}
 
 	ppu::rect ppu::get_screen() const
 	{
-		return rect{ 0, 0, 256, 256 };
+		return rect{ 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
 	}
 
 	ppu::win_size ppu::get_window_size() const
 	{
-		return { 160, 144 };
+		return { SCREEN_WIDTH, SCREEN_HEIGHT };
 	}
 }
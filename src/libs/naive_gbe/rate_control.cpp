@@ -0,0 +1,57 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/rate_control.hpp>
+#include <naive_gbe/ppu.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace naive_gbe
+{
+	rate_control::rate_control(double max_skew)
+		: max_skew_(max_skew)
+	{
+	}
+
+	void rate_control::reset()
+	{
+		speed_ = 1.0;
+		carry_ = 0.0;
+		fill_ = 0;
+	}
+
+	std::uint64_t rate_control::advance(std::uint64_t elapsed_us, std::size_t fill, std::size_t capacity)
+	{
+		double level = capacity ? static_cast<double>(fill) / capacity : 0.5;
+
+		// A ring still full since the last call has no reader, so there is nothing to pace against.
+		if (capacity && fill >= capacity && fill_ >= capacity)
+			level = 0.5;
+
+		fill_ = fill;
+
+		// Below half full the emulator runs slightly fast to refill the ring, above it slightly slow.
+		speed_ = 1.0 + std::clamp((0.5 - level) * 2.0, -1.0, 1.0) * max_skew_;
+
+		double cycles = std::min<std::uint64_t>(elapsed_us, MAX_ELAPSED_US) * (ppu::CYCLES_PER_SECOND / 1e6) * speed_ + carry_;
+		double whole = std::floor(cycles);
+
+		carry_ = cycles - whole;
+
+		return static_cast<std::uint64_t>(whole);
+	}
+
+	double rate_control::get_speed() const
+	{
+		return speed_;
+	}
+
+	double rate_control::get_max_skew() const
+	{
+		return max_skew_;
+	}
+}
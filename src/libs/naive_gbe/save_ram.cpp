@@ -0,0 +1,253 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/save_ram.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#if _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace naive_gbe
+{
+	namespace
+	{
+		std::size_t get_page_shift()
+		{
+#if _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			std::size_t page_size = info.dwPageSize;
+#else
+			std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+			std::size_t shift = 0;
+			while ((std::size_t{ 1 } << (shift + 1)) <= page_size)
+				++shift;
+
+			return shift;
+		}
+	}
+
+	save_ram::~save_ram()
+	{
+		close();
+	}
+
+	void save_ram::open(std::size_t size)
+	{
+		close();
+
+		volatile_.assign(size, 0);
+		data_ = volatile_.data();
+		size_ = size;
+	}
+
+	bool save_ram::open(std::string const& file_name, std::size_t size, std::error_code& ec)
+	{
+		close();
+
+		if (!size)
+			return true;
+
+		page_shift_ = get_page_shift();
+
+#if _WIN32
+		HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+			nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			ec = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+			0, static_cast<DWORD>(size), nullptr);
+
+		void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+
+		if (!view)
+		{
+			ec = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+
+			if (mapping)
+				CloseHandle(mapping);
+
+			CloseHandle(file);
+			return false;
+		}
+
+		CloseHandle(mapping);
+		file_ = file;
+		data_ = static_cast<std::uint8_t*>(view);
+#else
+		int fd = ::open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+
+		if (fd < 0)
+		{
+			ec = std::error_code(errno, std::generic_category());
+			return false;
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) < 0 ||
+			(static_cast<std::size_t>(st.st_size) < size && ftruncate(fd, size) < 0))
+		{
+			ec = std::error_code(errno, std::generic_category());
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+
+		if (view == MAP_FAILED)
+		{
+			ec = std::error_code(errno, std::generic_category());
+			return false;
+		}
+
+		data_ = static_cast<std::uint8_t*>(view);
+#endif
+
+		size_ = size;
+		dirty_.assign(((size - 1) >> page_shift_) + 1, false);
+		num_dirty_ = 0;
+		last_flush_ = 0;
+
+		return true;
+	}
+
+	void save_ram::close()
+	{
+		if (is_mapped())
+		{
+			sync_pages(0, dirty_.size(), true);
+
+#if _WIN32
+			UnmapViewOfFile(data_);
+			CloseHandle(file_);
+			file_ = nullptr;
+#else
+			munmap(data_, size_);
+#endif
+		}
+
+		volatile_.clear();
+		dirty_.clear();
+		num_dirty_ = 0;
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	bool save_ram::is_mapped() const
+	{
+		return data_ && !dirty_.empty();
+	}
+
+	std::uint8_t* save_ram::get_data()
+	{
+		return data_;
+	}
+
+	std::size_t save_ram::get_size() const
+	{
+		return size_;
+	}
+
+	void save_ram::mark_dirty(std::size_t offset)
+	{
+		std::size_t page = offset >> page_shift_;
+
+		if (page < dirty_.size() && !dirty_[page])
+		{
+			dirty_[page] = true;
+			++num_dirty_;
+		}
+	}
+
+	std::size_t save_ram::get_dirty_pages() const
+	{
+		return num_dirty_;
+	}
+
+	void save_ram::set_flush_interval(std::size_t cycles)
+	{
+		interval_ = cycles;
+	}
+
+	std::size_t save_ram::get_flush_interval() const
+	{
+		return interval_;
+	}
+
+	void save_ram::update(std::size_t cycle)
+	{
+		if (cycle < last_flush_)
+			last_flush_ = cycle;
+
+		if (cycle - last_flush_ < interval_)
+			return;
+
+		last_flush_ = cycle;
+
+		if (num_dirty_)
+			flush();
+	}
+
+	std::size_t save_ram::flush()
+	{
+		std::size_t flushed = num_dirty_;
+		std::size_t page = 0;
+
+		while (num_dirty_ && page < dirty_.size())
+		{
+			if (!dirty_[page])
+			{
+				++page;
+				continue;
+			}
+
+			std::size_t first = page;
+
+			while (page < dirty_.size() && dirty_[page])
+			{
+				dirty_[page++] = false;
+				--num_dirty_;
+			}
+
+			sync_pages(first, page - first, false);
+		}
+
+		return flushed;
+	}
+
+	void save_ram::sync_pages(std::size_t first, std::size_t count, bool wait)
+	{
+		std::size_t offset = first << page_shift_;
+		std::size_t length = std::min(count << page_shift_, size_ - offset);
+
+#if _WIN32
+		FlushViewOfFile(data_ + offset, length);
+
+		if (wait)
+			FlushFileBuffers(file_);
+#else
+		msync(data_ + offset, length, wait ? MS_SYNC : MS_ASYNC);
+#endif
+	}
+}
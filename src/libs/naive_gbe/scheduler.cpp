@@ -0,0 +1,87 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/scheduler.hpp>
+
+namespace naive_gbe
+{
+	void scheduler::reset()
+	{
+		events_.fill(entry{});
+		next_ = NEVER;
+		cycle_ = 0;
+	}
+
+	void scheduler::schedule(event id, std::uint64_t cycle, handler handler, void* context)
+	{
+		bool moved = events_[id].cycle_ == next_;
+
+		events_[id] = entry{ cycle, handler, context };
+
+		// Moving the earliest event later has to expose whatever is due next.
+		if (moved)
+			update_next();
+		else if (cycle < next_)
+			next_ = cycle;
+	}
+
+	void scheduler::cancel(event id)
+	{
+		events_[id] = entry{};
+		update_next();
+	}
+
+	bool scheduler::is_pending(event id) const
+	{
+		return events_[id].cycle_ != NEVER;
+	}
+
+	std::uint64_t scheduler::get_event_cycle(event id) const
+	{
+		return events_[id].cycle_;
+	}
+
+	std::uint64_t scheduler::get_next_cycle() const
+	{
+		return next_;
+	}
+
+	std::uint64_t scheduler::get_cycle() const
+	{
+		return cycle_;
+	}
+
+	void scheduler::dispatch()
+	{
+		while (cycle_ >= next_)
+		{
+			std::size_t due = 0;
+
+			for (std::size_t id = 1; id < events_.size(); ++id)
+			{
+				if (events_[id].cycle_ < events_[due].cycle_)
+					due = id;
+			}
+
+			entry current = events_[due];
+			events_[due] = entry{};
+			update_next();
+
+			current.handler_(current.context_, current.cycle_);
+		}
+	}
+
+	void scheduler::update_next()
+	{
+		next_ = NEVER;
+
+		for (auto const& entry : events_)
+		{
+			if (entry.cycle_ < next_)
+				next_ = entry.cycle_;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/speed_meter.hpp>
+
+namespace naive_gbe
+{
+	void speed_meter::reset()
+	{
+		*this = speed_meter{};
+	}
+
+	void speed_meter::add(std::uint64_t cycles, duration busy, time_point now)
+	{
+		time_point begin = now - busy;
+
+		// A long idle gap (pause, no cartridge) would read as a slowdown, so the window restarts.
+		if (last_ == time_point{} || begin - last_ > std::chrono::microseconds{ MAX_GAP_US })
+		{
+			start_ = begin;
+			cycles_ = 0;
+			busy_ = {};
+		}
+
+		last_ = now;
+		cycles_ += cycles;
+		busy_ += busy;
+
+		if (cycles_ < WINDOW_CYCLES)
+			return;
+
+		auto wall = std::chrono::duration<double>(now - start_).count();
+
+		frame_time_ = busy_ * ppu::CYCLES_PER_FRAME / cycles_;
+		speed_ = wall > 0 ? cycles_ / (wall * ppu::CYCLES_PER_SECOND) : 0.0;
+
+		start_ = now;
+		cycles_ = 0;
+		busy_ = {};
+	}
+
+	speed_meter::duration speed_meter::get_frame_time() const
+	{
+		return frame_time_;
+	}
+
+	double speed_meter::get_speed() const
+	{
+		return speed_;
+	}
+}
@@ -0,0 +1,260 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/video_recorder.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace naive_gbe
+{
+	namespace
+	{
+		std::uint8_t get_luma(std::uint32_t rgba)
+		{
+			std::uint32_t r = rgba & 0xff;
+			std::uint32_t g = (rgba >> 8) & 0xff;
+			std::uint32_t b = (rgba >> 16) & 0xff;
+
+			return static_cast<std::uint8_t>((r * 77 + g * 150 + b * 29 + 128) >> 8);
+		}
+	}
+
+	video_recorder::video_recorder(std::size_t capacity)
+		: slots_(std::max<std::size_t>(capacity, 1))
+		, head_(0)
+		, tail_(0)
+		, dropped_(0)
+		, stop_(false)
+	{
+	}
+
+	video_recorder::~video_recorder()
+	{
+		std::error_code ec;
+		stop(ec);
+	}
+
+	void video_recorder::set_palette(rgba_palette const& palette)
+	{
+		palette_ = palette;
+	}
+
+	bool video_recorder::start(std::string const& file_name, format format, std::error_code& ec)
+	{
+		if (recording_ && !stop(ec))
+			return false;
+
+		ofs_.open(file_name, std::ios::binary | std::ios::trunc);
+
+		if (!ofs_)
+		{
+			ec = std::error_code{ errno, std::generic_category() };
+			return false;
+		}
+
+		if (format == FORMAT_RGBA)
+		{
+			index_.open(file_name + ".idx", std::ios::trunc);
+
+			if (!index_)
+			{
+				ec = std::error_code{ errno, std::generic_category() };
+				ofs_.close();
+				return false;
+			}
+		}
+
+		for (auto& slot : slots_)
+			slot.shades_.resize(FRAME_PIXELS);
+
+		format_ = format;
+		offset_ = 0;
+		error_.clear();
+		buffer_.clear();
+		buffer_.reserve(BUFFER_SIZE);
+		head_.store(0, std::memory_order_relaxed);
+		tail_.store(0, std::memory_order_relaxed);
+		dropped_.store(0, std::memory_order_relaxed);
+		stop_.store(false, std::memory_order_relaxed);
+
+		if (format_ == FORMAT_Y4M)
+		{
+			std::string header = "YUV4MPEG2 W" + std::to_string(FRAME_WIDTH) + " H" + std::to_string(FRAME_HEIGHT) +
+				" F" + std::to_string(ppu::CYCLES_PER_SECOND) + ":" + std::to_string(ppu::CYCLES_PER_FRAME) +
+				" Ip A1:1 C420jpeg\n";
+
+			append(header.data(), header.size());
+		}
+
+		writer_ = std::thread(&video_recorder::write_loop, this);
+		recording_ = true;
+
+		return true;
+	}
+
+	bool video_recorder::stop(std::error_code& ec)
+	{
+		if (!recording_)
+			return true;
+
+		stop_.store(true, std::memory_order_release);
+		writer_.join();
+		recording_ = false;
+
+		flush();
+		ofs_.close();
+
+		if (!ofs_ && !error_)
+			error_ = std::error_code{ errno, std::generic_category() };
+
+		if (index_.is_open())
+		{
+			index_.close();
+
+			if (!index_ && !error_)
+				error_ = std::error_code{ errno, std::generic_category() };
+		}
+
+		if (error_)
+		{
+			ec = error_;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool video_recorder::is_recording() const
+	{
+		return recording_;
+	}
+
+	bool video_recorder::push(std::uint8_t const* shades, std::size_t frame)
+	{
+		std::size_t head = head_.load(std::memory_order_relaxed);
+
+		if (head - tail_.load(std::memory_order_acquire) == slots_.size())
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		slot& slot = slots_[head % slots_.size()];
+
+		std::memcpy(slot.shades_.data(), shades, FRAME_PIXELS);
+		slot.palette_ = palette_;
+		slot.frame_ = frame;
+
+		head_.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	std::size_t video_recorder::get_recorded() const
+	{
+		return tail_.load(std::memory_order_acquire);
+	}
+
+	std::size_t video_recorder::get_dropped() const
+	{
+		return dropped_.load(std::memory_order_relaxed);
+	}
+
+	void video_recorder::on_frame(void* context, std::uint8_t const* shades, std::size_t frame)
+	{
+		static_cast<video_recorder*>(context)->push(shades, frame);
+	}
+
+	void video_recorder::write_loop()
+	{
+		for (;;)
+		{
+			bool stopping = stop_.load(std::memory_order_acquire);
+			std::size_t tail = tail_.load(std::memory_order_relaxed);
+			std::size_t head = head_.load(std::memory_order_acquire);
+
+			if (tail == head)
+			{
+				if (stopping)
+					return;
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			for (; tail != head; ++tail)
+			{
+				encode(slots_[tail % slots_.size()]);
+				tail_.store(tail + 1, std::memory_order_release);
+			}
+		}
+	}
+
+	void video_recorder::encode(slot const& slot)
+	{
+		if (format_ == FORMAT_Y4M)
+		{
+			static char const frame_header[] = "FRAME\n";
+			std::array<std::uint8_t, 4> luma;
+			std::array<std::uint8_t, FRAME_WIDTH> row;
+
+			for (std::size_t shade = 0; shade < luma.size(); ++shade)
+				luma[shade] = get_luma(slot.palette_[shade]);
+
+			append(frame_header, sizeof(frame_header) - 1);
+
+			for (std::size_t y = 0; y < FRAME_HEIGHT; ++y)
+			{
+				std::uint8_t const* shades = &slot.shades_[y * FRAME_WIDTH];
+
+				for (std::size_t x = 0; x < FRAME_WIDTH; ++x)
+					row[x] = luma[shades[x] & 0x03];
+
+				append(row.data(), row.size());
+			}
+
+			row.fill(0x80);
+
+			for (std::size_t plane = 0; plane < 2; ++plane)
+			{
+				for (std::size_t y = 0; y < FRAME_HEIGHT / 2; ++y)
+					append(row.data(), FRAME_WIDTH / 2);
+			}
+		}
+		else
+		{
+			pixels_.resize(FRAME_PIXELS);
+			kernels_.expand(slot.shades_.data(), FRAME_PIXELS, slot.palette_, pixels_.data());
+
+			index_ << slot.frame_ << ' ' << offset_ << '\n';
+			append(pixels_.data(), pixels_.size() * sizeof(std::uint32_t));
+		}
+	}
+
+	void video_recorder::append(void const* data, std::size_t size)
+	{
+		if (buffer_.size() + size > BUFFER_SIZE)
+			flush();
+
+		auto bytes = static_cast<char const*>(data);
+		buffer_.insert(buffer_.end(), bytes, bytes + size);
+		offset_ += size;
+	}
+
+	void video_recorder::flush()
+	{
+		if (buffer_.empty())
+			return;
+
+		ofs_.write(buffer_.data(), buffer_.size());
+		buffer_.clear();
+
+		if (!ofs_ && !error_)
+			error_ = std::error_code{ errno, std::generic_category() };
+	}
+}
@@ -0,0 +1,92 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <naive_gbe/worker_pool.hpp>
+
+namespace naive_gbe
+{
+	worker_pool::worker_pool(std::size_t num_threads)
+		: next_(0)
+	{
+		for (std::size_t index = 0; index < num_threads; ++index)
+			threads_.emplace_back(&worker_pool::work, this);
+	}
+
+	worker_pool::~worker_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+
+		wake_.notify_all();
+
+		for (auto& thread : threads_)
+			thread.join();
+	}
+
+	std::size_t worker_pool::get_num_threads() const
+	{
+		return threads_.size();
+	}
+
+	void worker_pool::run(std::size_t count, task const& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			task_ = &task;
+			count_ = count;
+			next_.store(0, std::memory_order_relaxed);
+			busy_ = threads_.size();
+			++batch_;
+		}
+
+		wake_.notify_all();
+		process();
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [this] { return busy_ == 0; });
+		task_ = nullptr;
+	}
+
+	void worker_pool::work()
+	{
+		std::size_t batch = 0;
+
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				wake_.wait(lock, [&] { return stop_ || batch_ != batch; });
+
+				if (stop_)
+					return;
+
+				batch = batch_;
+			}
+
+			process();
+
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (--busy_ == 0)
+				done_.notify_one();
+		}
+	}
+
+	void worker_pool::process()
+	{
+		for (;;)
+		{
+			std::size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+
+			if (index >= count_)
+				return;
+
+			(*task_)(index);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <naive_gbe/batch_runner.hpp>
+
+int report_error(std::string const& message, std::error_code ec = {})
+{
+	std::string detail;
+	if (ec)
+		detail = ". Error: " + ec.message() + ".";
+
+	std::cerr << message << detail << '\n';
+
+	return EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
+{
+	using naive_gbe::batch_runner;
+
+	if (argc < 2 || argc > 3)
+		return report_error("Usage: naive_gbe_batch manifest_file [num_threads]");
+
+	std::size_t num_threads = batch_runner::get_default_threads();
+
+	if (argc == 3)
+	{
+		try
+		{
+			num_threads = std::stoul(argv[2]);
+		}
+		catch (std::exception&)
+		{
+			return report_error("Invalid thread count: " + std::string{ argv[2] });
+		}
+	}
+
+	std::error_code ec;
+	batch_runner::job_list jobs;
+
+	if (!batch_runner::load_manifest(argv[1], jobs, ec))
+		return report_error("Could not load manifest file: " + std::string{ argv[1] }, ec);
+
+	std::size_t failed = 0;
+	auto start = std::chrono::steady_clock::now();
+	batch_runner runner{ num_threads };
+
+	runner.run(jobs, [&failed](auto const& job, auto const& result)
+	{
+		std::cout << batch_runner::to_json(job, result) << std::endl;
+
+		if (result.error_ || result.desync_)
+			++failed;
+	});
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << jobs.size() << " jobs, " << failed << " failed, "
+		<< runner.get_num_threads() << " threads, " << elapsed << " s\n";
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
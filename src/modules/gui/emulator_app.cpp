@@ -11,15 +11,18 @@
 #include "state_help.hpp"
 #include "state_emulating.hpp"
 
+#include <iostream>
+
 emulator_app::emulator_app(std::string const& assets_dir)
+	: runner_{ emulator_ }
 {
 	auto& engine = get_engine();
 
 	get_engine().set_assets_dir(assets_dir);
 
-	add_state(std::make_shared<state_no_rom>(engine, data_, emulator_));
-	add_state(std::make_shared<state_help>(engine, data_, emulator_));
-	add_state(std::make_shared<state_emulating>(engine, data_, emulator_));
+	add_state(std::make_shared<state_no_rom>(engine, data_, runner_));
+	add_state(std::make_shared<state_help>(engine, data_, runner_));
+	add_state(std::make_shared<state_emulating>(engine, data_, runner_));
 
 	set_state(state_base::state::NO_ROM);
 }
@@ -29,6 +32,8 @@ bool emulator_app::load_rom(std::string const& rom_path, std::error_code& ec)
 	if (!emulator_.load_rom(rom_path, ec))
 		return false;
 
+	data_.rom_path_ = rom_path;
+
 	set_state(state_base::state::EMULATING);
 
 	return true;
@@ -50,5 +55,20 @@ int emulator_app::run()
 	data_.debug_font_ = engine.create_font("debug", "JetBrainsMono-Bold.ttf", 20);
 	data_.help_font_ = engine.create_font("help", "JetBrainsMono-Bold.ttf", 30);
 
-	return game::run();
+	auto sample_rate = engine.open_audio(naive_gbe::apu::DEFAULT_SAMPLE_RATE, 1024,
+		[this](std::int16_t* samples, std::size_t frames) { emulator_.get_audio().read(samples, frames); });
+
+	if (sample_rate)
+		emulator_.set_sample_rate(sample_rate);
+	else
+		std::cerr << "warning: no audio device, running without sound\n";
+
+	runner_.start();
+
+	int exit_code = game::run();
+
+	runner_.stop();
+	engine.close_audio();
+
+	return exit_code;
 }
\ No newline at end of file
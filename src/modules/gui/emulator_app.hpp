@@ -11,6 +11,7 @@
 
 #include <naive_2dge/game.hpp>
 #include <naive_gbe/emulator.hpp>
+#include <naive_gbe/emulator_thread.hpp>
 
 #include "emulator_data.hpp"
 
@@ -29,5 +30,7 @@ private:
 
 	naive_gbe::emulator		emulator_;
 
+	naive_gbe::emulator_thread	runner_;
+
 	emulator_data			data_;
 };
@@ -28,4 +28,6 @@ struct emulator_data
 	naive_2dge::font::ptr		help_font_			= nullptr;
 
 	std::vector<std::string>	debug_text_			= {};
+
+	std::string					rom_path_			= {};
 };
\ No newline at end of file
@@ -8,10 +8,11 @@
 using namespace naive_gbe;
 using namespace naive_2dge;
 
-state_base::state_base(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator, std::size_t next_state)
+state_base::state_base(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner, std::size_t next_state)
 	: naive_2dge::state(engine)
 	, data_(data)
-	, emulator_(emulator)
+	, runner_(runner)
+	, emulator_(runner.get_emulator())
 	, next_state_(next_state)
 	, prev_state_(next_state)
 {
@@ -54,7 +55,7 @@ void state_base::on_update_debug()
 	debug("STRETCH: " + stretch);
 	debug(" ");
 
-	auto& cpu = emulator_.get_cpu();
+	auto const& status = runner_.get_status();
 
 	std::ostringstream out;
 	out << reg_fmt(lr35902::r16::AF) << " "
@@ -67,17 +68,17 @@ void state_base::on_update_debug()
 	out.str("");
 	out << reg_fmt(lr35902::r16::SP) << " "
 		<< reg_fmt(lr35902::r16::PC) << " "
-		<< "Z=" << cpu.get_flag(lr35902::flags::ZERO) << " "
-		<< "N=" << cpu.get_flag(lr35902::flags::SUBTRACTION) << " "
-		<< "H=" << cpu.get_flag(lr35902::flags::HALF_CARRY) << " "
-		<< "C=" << cpu.get_flag(lr35902::flags::CARRY);
+		<< "Z=" << bool(status.flags_ & lr35902::flags::ZERO) << " "
+		<< "N=" << bool(status.flags_ & lr35902::flags::SUBTRACTION) << " "
+		<< "H=" << bool(status.flags_ & lr35902::flags::HALF_CARRY) << " "
+		<< "C=" << bool(status.flags_ & lr35902::flags::CARRY);
 
 	debug(out.str());
-	debug("CYCLE: " + std::to_string(cpu.get_cycle()));
-	debug("STATE: " + cpu_state_fmt(cpu.get_state()));
+	debug("CYCLE: " + std::to_string(status.cycle_));
+	debug("STATE: " + cpu_state_fmt(status.cpu_state_));
 	debug("JOYPAD: " + joypad_state_fmt());
-	debug("INTERRUPTIONS: " + std::to_string(cpu.get_ime()));
-	debug("NEXT_OP: " + emulator_.disassembly());
+	debug("INTERRUPTIONS: " + std::to_string(status.ime_));
+	debug("NEXT_OP: " + status.next_op_);
 
 	draw_debug_overlay();
 }
@@ -183,7 +184,7 @@ std::string state_base::joypad_state_fmt() const
 {
 	std::ostringstream out;
 
-	out << emulator_.get_joypad();
+	out << runner_.get_status().joypad_;
 
 	return out.str();
 }
@@ -235,11 +236,11 @@ std::string state_base::reg_fmt(naive_gbe::lr35902::r16 reg)
 	}
 
 	std::ostringstream out;
-	auto const& cpu = emulator_.get_cpu();
+	auto const& status = runner_.get_status();
 
 	out << reg_name << "="
 		<< std::setw(4) << std::setfill('0')
-		<< std::hex << cpu.get_register(reg);
+		<< std::hex << status.get_register(reg);
 
 	return out.str();
 }
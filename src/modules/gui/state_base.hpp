@@ -10,6 +10,7 @@
 #include <naive_2dge/engine.hpp>
 #include <naive_2dge/types.hpp>
 #include <naive_gbe/emulator.hpp>
+#include <naive_gbe/emulator_thread.hpp>
 
 #include "emulator_data.hpp"
 
@@ -39,7 +40,7 @@ public:
 		SCALED_4X,
 	};
 
-	state_base(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator, std::size_t next_state);
+	state_base(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner, std::size_t next_state);
 
 	virtual void on_create() override;
 
@@ -75,6 +76,8 @@ protected:
 
 	void throw_error(std::string const& description, std::string const& detail) const;
 
+	naive_gbe::emulator_thread&	runner_;
+
 	naive_gbe::emulator&		emulator_;
 
 	std::size_t					prev_state_;
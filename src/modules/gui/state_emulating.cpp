@@ -7,14 +7,15 @@
 #include "state_emulating.hpp"
 using namespace naive_gbe;
 
-state_emulating::state_emulating(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator)
-	: state_base(engine, data, emulator, state::EMULATING)
+state_emulating::state_emulating(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner)
+	: state_base(engine, data, runner, state::EMULATING)
 {
 	using namespace std::placeholders;
 	add_event_handler(SDL_KEYDOWN, std::bind(&state_emulating::on_key_down, this, _1));
 	add_event_handler(SDL_KEYUP, std::bind(&state_emulating::on_key_up, this, _1));
 
 	pallete_ = create_pallete();
+	emulator_.set_output(naive_gbe::ppu::OUTPUT_RGBA32, pallete_);
 }
 
 void state_emulating::on_create()
@@ -34,29 +35,32 @@ void state_emulating::on_enter(std::size_t prev_state)
 
 void state_emulating::on_update()
 {
-	if (!paused_)
-	{
-		using cpu_state = naive_gbe::lr35902::state;
-		auto& cpu = emulator_.get_cpu();
+	runner_.acquire_status();
+
+	auto const& status = runner_.get_status();
 
-		//while (steps_to_run_ && cpu.get_state() == cpu_state::READY)
-		//{
-		//	cpu.step();
-		//	--steps_to_run_;
-		//	++steps_;
-		//}
+	if (status.error_)
+		throw std::system_error(status.error_);
 
-		steps_ += emulator_.run();
+	if (!paused_)
+	{
+		debug("STEPS: " + std::to_string(status.steps_));
 
-		auto& mmu = emulator_.get_mmu();
+		debug("LCDC : " + std::to_string((int)status.lcdc_));
+		debug("SCY  : " + std::to_string((int)status.scy_));
+		debug("LY   : " + std::to_string((int)status.ly_));
 
-		debug("STEPS: " + std::to_string(steps_));
+		debug("SKIP : " + std::to_string(status.skipped_));
+		debug("RATE : " + std::to_string(status.speed_));
+		debug("SPEED: " + speed_fmt(status.throughput_) + (status.turbo_ ? " TURBO" : ""));
+		debug("FRAME: " + std::to_string(status.frame_time_.count() / 1000) + " us");
+		debug("MOVIE: " + movie_fmt(status));
+		debug("AUDIO: " + std::to_string(status.audio_lead_.count() / 1000) + " ms");
 
-		debug("LCDC : " + std::to_string((int)mmu[naive_gbe::ppu::IO_REG_LCDC]));
-		debug("SCY  : " + std::to_string((int)mmu[naive_gbe::ppu::IO_REG_SCY]));
-		debug("LY   : " + std::to_string((int)mmu[naive_gbe::ppu::IO_REG_LY]));
+		auto& frames = emulator_.get_frames();
 
-		update_vram();
+		if (frames.acquire())
+			update_vram(frames.get_front());
 	}
 
 	auto [win_w, win_h] = engine_.get_window_size();
@@ -75,6 +79,12 @@ void state_emulating::on_update()
 void state_emulating::toggle_pause()
 {
 	paused_ = !paused_;
+
+	if (paused_)
+		runner_.pause();
+	else
+		runner_.resume();
+
 	SDL_ShowCursor(paused_ ? SDL_ENABLE : SDL_DISABLE);
 }
 
@@ -85,28 +95,28 @@ std::size_t state_emulating::on_key_down(SDL_Event const& event)
 	switch (event.key.keysym.sym)
 	{
 	case SDLK_1:
-		emulator_.set_joypad(joypad_input::START, true);
+		runner_.set_joypad(joypad_input::START, true);
 		break;
 	case SDLK_2:
-		emulator_.set_joypad(joypad_input::SELECT, true);
+		runner_.set_joypad(joypad_input::SELECT, true);
 		break;
 	case SDLK_a:
-		emulator_.set_joypad(joypad_input::A, true);
+		runner_.set_joypad(joypad_input::A, true);
 		break;
 	case SDLK_s:
-		emulator_.set_joypad(joypad_input::B, true);
+		runner_.set_joypad(joypad_input::B, true);
 		break;
 	case SDLK_UP:
-		emulator_.set_joypad(joypad_input::UP, true);
+		runner_.set_joypad(joypad_input::UP, true);
 		break;
 	case SDLK_DOWN:
-		emulator_.set_joypad(joypad_input::DOWN, true);
+		runner_.set_joypad(joypad_input::DOWN, true);
 		break;
 	case SDLK_LEFT:
-		emulator_.set_joypad(joypad_input::LEFT, true);
+		runner_.set_joypad(joypad_input::LEFT, true);
 		break;
 	case SDLK_RIGHT:
-		emulator_.set_joypad(joypad_input::RIGHT, true);
+		runner_.set_joypad(joypad_input::RIGHT, true);
 		break;
 	case SDLK_F8:
 		steps_to_run_ += 50;
@@ -121,11 +131,21 @@ std::size_t state_emulating::on_key_down(SDL_Event const& event)
 		steps_to_run_ += 24880;
 		//steps_to_run_ += 24902 - 10;
 		break;
+	case SDLK_TAB:
+		if (!event.key.repeat)
+			runner_.set_turbo(true);
+		break;
+	case SDLK_F5:
+		toggle_movie(movie_mode::RECORDING);
+		break;
+	case SDLK_F6:
+		toggle_movie(movie_mode::PLAYING);
+		break;
 	case SDLK_p:
 		toggle_pause();
 		break;
 	case SDLK_r:
-		emulator_.reset();
+		runner_.reset();
 		steps_to_run_ = 0;
 		break;
 	}
@@ -140,34 +160,88 @@ std::size_t state_emulating::on_key_up(SDL_Event const& event)
 	switch (event.key.keysym.sym)
 	{
 	case SDLK_1:
-		emulator_.set_joypad(joypad_input::START, false);
+		runner_.set_joypad(joypad_input::START, false);
 		break;
 	case SDLK_2:
-		emulator_.set_joypad(joypad_input::SELECT, false);
+		runner_.set_joypad(joypad_input::SELECT, false);
 		break;
 	case SDLK_a:
-		emulator_.set_joypad(joypad_input::A, false);
+		runner_.set_joypad(joypad_input::A, false);
 		break;
 	case SDLK_s:
-		emulator_.set_joypad(joypad_input::B, false);
+		runner_.set_joypad(joypad_input::B, false);
 		break;
 	case SDLK_UP:
-		emulator_.set_joypad(joypad_input::UP, false);
+		runner_.set_joypad(joypad_input::UP, false);
 		break;
 	case SDLK_DOWN:
-		emulator_.set_joypad(joypad_input::DOWN, false);
+		runner_.set_joypad(joypad_input::DOWN, false);
 		break;
 	case SDLK_LEFT:
-		emulator_.set_joypad(joypad_input::LEFT, false);
+		runner_.set_joypad(joypad_input::LEFT, false);
 		break;
 	case SDLK_RIGHT:
-		emulator_.set_joypad(joypad_input::RIGHT, false);
+		runner_.set_joypad(joypad_input::RIGHT, false);
+		break;
+	case SDLK_TAB:
+		runner_.set_turbo(false);
 		break;
 	}
 
 	return next_state_;
 }
 
+void state_emulating::toggle_movie(movie_mode mode)
+{
+	auto movie_path = emulator_.get_movie_path(data_.rom_path_);
+
+	if (movie_ == mode)
+	{
+		runner_.stop_movie(mode == movie_mode::RECORDING ? movie_path : std::string{});
+		movie_ = movie_mode::OFF;
+		return;
+	}
+
+	if (mode == movie_mode::RECORDING)
+		runner_.record_movie();
+	else
+		runner_.play_movie(movie_path);
+
+	movie_ = mode;
+}
+
+std::string state_emulating::movie_fmt(naive_gbe::emulator_thread::status const& status)
+{
+	if (status.movie_error_)
+		return status.movie_error_.message();
+
+	std::string text = "OFF";
+
+	switch (status.movie_mode_)
+	{
+	case movie_mode::OFF:
+		break;
+	case movie_mode::RECORDING:
+		text = "RECORDING";
+		break;
+	case movie_mode::PLAYING:
+		text = "PLAYING";
+		break;
+	}
+
+	return text + " " + std::to_string(status.movie_frames_);
+}
+
+std::string state_emulating::speed_fmt(double speed)
+{
+	std::ostringstream out;
+
+	out << std::fixed << std::setprecision(1)
+		<< "x" << speed;
+
+	return out.str();
+}
+
 state_emulating::pallete state_emulating::create_pallete() const
 {
 	SDL_PixelFormat* format = SDL_AllocFormat(SDL_PIXELFORMAT_RGBA32);
@@ -176,10 +250,10 @@ state_emulating::pallete state_emulating::create_pallete() const
 
 	pallete pallete =
 	{
-		{ 0, SDL_MapRGBA(format,   0,   0,   0, 255) },
-		{ 1, SDL_MapRGBA(format,  63,  63,  63, 255) },
-		{ 2, SDL_MapRGBA(format, 127, 127, 127, 255) },
-		{ 3, SDL_MapRGBA(format, 255, 255, 255, 255) },
+		SDL_MapRGBA(format, 255, 255, 255, 255),
+		SDL_MapRGBA(format, 170, 170, 170, 255),
+		SDL_MapRGBA(format,  85,  85,  85, 255),
+		SDL_MapRGBA(format,   0,   0,   0, 255),
 	};
 
 	SDL_FreeFormat(format);
@@ -187,33 +261,12 @@ state_emulating::pallete state_emulating::create_pallete() const
 	return pallete;
 }
 
-void state_emulating::update_vram()
+void state_emulating::update_vram(naive_gbe::frame_exchange::frame const& frame)
 {
 	assert(vram_ != nullptr);
 
-	std::uint32_t* pixels = nullptr;
-	int pitch = 0;
+	auto const& ppu = emulator_.get_ppu();
 
 	SDL_Texture* texture = reinterpret_cast<SDL_Texture*>(vram_->get_resource());
-	SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&pixels), &pitch);
-
-	auto ppu = emulator_.get_ppu();
-	auto vram = ppu.get_video_ram();
-
-	auto screen = ppu.get_screen();
-	auto window = ppu.get_window();
-
-	std::size_t total = 0;
-	for (auto row = 0; row < window.height; ++row)
-	{
-		std::size_t offset = window.x_pos + (row + window.y_pos) * screen.width;
-
-		for (auto col = 0; col < window.width; ++col)
-		{
-			*pixels++ = pallete_[vram[offset + col]];
-			total++;
-		}
-	}
-
-	SDL_UnlockTexture(texture);
+	SDL_UpdateTexture(texture, nullptr, frame.rgba_.data(), ppu.get_screen_width() * sizeof(std::uint32_t));
 }
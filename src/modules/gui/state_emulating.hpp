@@ -13,7 +13,7 @@ class state_emulating
 {
 public:
 
-	state_emulating(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator);
+	state_emulating(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner);
 
 	void on_create() override;
 
@@ -25,7 +25,9 @@ private:
 
 	using keymap = std::unordered_map<SDL_Keycode, naive_gbe::emulator::joypad_input>;
 
-	using pallete = std::unordered_map<std::uint8_t, std::uint32_t>;
+	using pallete = naive_gbe::ppu::rgba_palette;
+
+	using movie_mode = naive_gbe::emulator::movie_mode;
 
 	std::size_t on_key_down(SDL_Event const& event);
 
@@ -33,17 +35,23 @@ private:
 
 	void toggle_pause();
 
+	void toggle_movie(movie_mode mode);
+
+	std::string movie_fmt(naive_gbe::emulator_thread::status const& status);
+
+	std::string speed_fmt(double speed);
+
 	pallete create_pallete() const;
 
-	void update_vram();
+	void update_vram(naive_gbe::frame_exchange::frame const& frame);
 
 	naive_2dge::texture::ptr	vram_			= nullptr;
 
 	std::size_t					steps_to_run_	= 0;
 
-	std::size_t					steps_			= 0;
-
 	bool						paused_			= false;
 
+	movie_mode					movie_			= movie_mode::OFF;
+
 	pallete						pallete_		= {};
 };
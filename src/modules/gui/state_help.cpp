@@ -6,8 +6,8 @@
 //
 #include "state_help.hpp"
 
-state_help::state_help(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator)
-	: state_base(engine, data, emulator, state::HELP)
+state_help::state_help(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner)
+	: state_base(engine, data, runner, state::HELP)
 {
 	using namespace std::placeholders;
 
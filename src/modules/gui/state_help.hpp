@@ -13,7 +13,7 @@ class state_help
 {
 public:
 
-	state_help(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator);
+	state_help(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner);
 
 	void on_create() override;
 
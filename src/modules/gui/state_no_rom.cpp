@@ -6,8 +6,8 @@
 //
 #include "state_no_rom.hpp"
 
-state_no_rom::state_no_rom(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator)
-	: state_base(engine, data, emulator, state::NO_ROM)
+state_no_rom::state_no_rom(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner)
+	: state_base(engine, data, runner, state::NO_ROM)
 {
 	using namespace std::placeholders;
 
@@ -40,11 +40,12 @@ void state_no_rom::on_update()
 
 std::size_t state_no_rom::on_drop_file(SDL_Event const& event)
 {
-	std::error_code ec;
 	std::string rom_path = event.drop.file;
 
-	if (!emulator_.load_rom(rom_path, ec))
-		throw std::system_error(ec);
+	if (!runner_.load_rom(rom_path))
+		throw std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again));
+
+	data_.rom_path_ = rom_path;
 
 	return state::EMULATING;
 }
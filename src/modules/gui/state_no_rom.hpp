@@ -13,7 +13,7 @@ class state_no_rom
 {
 public:
 
-	state_no_rom(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator& emulator);
+	state_no_rom(naive_2dge::engine& engine, emulator_data& data, naive_gbe::emulator_thread& runner);
 
 	void on_create() override;
 
@@ -0,0 +1,292 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <naive_gbe/apu.hpp>
+#include <naive_gbe/ppu.hpp>
+#include <naive_gbe/rate_control.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	std::vector<std::int16_t> drain(audio_ring& ring)
+	{
+		std::vector<std::int16_t> samples(ring.get_available() * audio_ring::NUM_CHANNELS);
+
+		ring.read(samples.data(), samples.size() / audio_ring::NUM_CHANNELS);
+
+		return samples;
+	}
+
+	void advance(mmu& mmu, std::uint64_t cycles)
+	{
+		auto& scheduler = mmu.get_scheduler();
+		std::uint64_t last = scheduler.get_cycle() + cycles;
+
+		for (std::uint64_t cycle = scheduler.get_cycle(); cycle < last; )
+		{
+			cycle = std::min(cycle + 1024, last);
+			scheduler.run(cycle);
+		}
+	}
+
+	void start_square(mmu& mmu)
+	{
+		mmu.write(apu::IO_REG_NR52, 0x80);
+		mmu.write(apu::IO_REG_NR50, 0x77);
+		mmu.write(apu::IO_REG_NR51, 0x02);
+		mmu.write(apu::IO_REG_NR21, 0x80);
+		mmu.write(apu::IO_REG_NR22, 0xf0);
+		mmu.write(apu::IO_REG_NR23, 0x00);
+		mmu.write(apu::IO_REG_NR24, 0x87);
+	}
+}
+
+TEST(audio_ring, read_write)
+{
+	audio_ring ring{ 4 };
+	std::int16_t in[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	std::int16_t out[6] = {};
+
+	EXPECT_EQ(ring.get_capacity(), 4);
+	EXPECT_EQ(ring.write(in, 5), 4);
+	EXPECT_EQ(ring.get_overruns(), 1);
+	EXPECT_EQ(ring.get_available(), 4);
+
+	EXPECT_EQ(ring.read(out, 2), 2);
+	EXPECT_EQ(out[0], 1);
+	EXPECT_EQ(out[3], 4);
+
+	EXPECT_EQ(ring.write(in + 8, 1), 1);
+	EXPECT_EQ(ring.read(out, 3), 3);
+	EXPECT_EQ(out[4], 9);
+	EXPECT_EQ(out[5], 10);
+
+	out[0] = -1;
+	EXPECT_EQ(ring.read(out, 1), 0);
+	EXPECT_EQ(out[0], 0);
+	EXPECT_EQ(ring.get_underruns(), 1);
+}
+
+TEST(audio_kernels, simd_matches_scalar)
+{
+	std::size_t count = 1000 + 13;
+	std::vector<std::int16_t> data(count * audio_kernels::NUM_CHANNELS);
+
+	for (std::size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<std::int16_t>((i * 7919) % 16384 - 8192);
+
+	audio_kernels::channel_samples channels;
+	for (std::size_t ch = 0; ch < audio_kernels::NUM_CHANNELS; ++ch)
+		channels[ch] = data.data() + ch * count;
+
+	audio_kernels::mix_gains gains = { 8, 0, 3, 8, 1, 8, 0, 8 };
+	audio_kernels scalar{ audio_kernels::isa::SCALAR };
+	std::vector<std::int16_t> expected(count * 2);
+
+	scalar.mix(channels, count, gains, expected.data());
+
+	EXPECT_EQ(expected[0], (data[0] * 8 + data[2 * count] * 3 + data[3 * count] * 8) >> audio_kernels::MIX_SHIFT);
+	EXPECT_EQ(expected[1], (data[0] + data[count] * 8 + data[3 * count] * 8) >> audio_kernels::MIX_SHIFT);
+
+	for (auto isa : { audio_kernels::isa::SSE2, audio_kernels::isa::AVX2 })
+	{
+		if (!audio_kernels::is_supported(isa))
+			continue;
+
+		audio_kernels kernels{ isa };
+		std::vector<std::int16_t> out(count * 2);
+
+		kernels.mix(channels, count, gains, out.data());
+
+		EXPECT_EQ(out, expected);
+	}
+}
+
+TEST(apu, power_and_status)
+{
+	mmu mmu;
+	apu apu{ mmu };
+
+	EXPECT_FALSE(apu.is_enabled());
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR52), 0x70);
+
+	mmu.write(apu::IO_REG_NR22, 0xf0);
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR22), 0x00);
+
+	start_square(mmu);
+	EXPECT_TRUE(apu.is_channel_on(apu::CHANNEL_SQUARE2));
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR52), 0xf2);
+
+	mmu.write(apu::IO_REG_NR22, 0x00);
+	EXPECT_FALSE(apu.is_channel_on(apu::CHANNEL_SQUARE2));
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR52), 0xf0);
+
+	mmu.write(apu::IO_REG_NR52, 0x00);
+	EXPECT_FALSE(apu.is_enabled());
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR51), 0x00);
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR52), 0x70);
+}
+
+TEST(apu, length_expires)
+{
+	mmu mmu;
+	apu apu{ mmu };
+
+	mmu.write(apu::IO_REG_NR52, 0x80);
+	mmu.write(apu::IO_REG_NR41, 0x3e);
+	mmu.write(apu::IO_REG_NR42, 0xf0);
+	mmu.write(apu::IO_REG_NR44, 0xc0);
+
+	EXPECT_TRUE(apu.is_channel_on(apu::CHANNEL_NOISE));
+
+	advance(mmu, apu::CYCLES_PER_STEP * 2);
+	EXPECT_TRUE(apu.is_channel_on(apu::CHANNEL_NOISE));
+
+	advance(mmu, apu::CYCLES_PER_STEP);
+	EXPECT_FALSE(apu.is_channel_on(apu::CHANNEL_NOISE));
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR52), 0xf0);
+}
+
+TEST(apu, sweep_overflow)
+{
+	mmu mmu;
+	apu apu{ mmu };
+
+	mmu.write(apu::IO_REG_NR52, 0x80);
+	mmu.write(apu::IO_REG_NR10, 0x11);
+	mmu.write(apu::IO_REG_NR12, 0xf0);
+	mmu.write(apu::IO_REG_NR13, 0x00);
+	mmu.write(apu::IO_REG_NR14, 0x84);
+
+	EXPECT_TRUE(apu.is_channel_on(apu::CHANNEL_SQUARE1));
+
+	advance(mmu, apu::CYCLES_PER_STEP * 4);
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR13), 0x00);
+	EXPECT_EQ(mmu.read(apu::IO_REG_NR14) & 0x07, 0x06);
+	EXPECT_FALSE(apu.is_channel_on(apu::CHANNEL_SQUARE1));
+}
+
+TEST(apu, square_wave_output)
+{
+	mmu mmu;
+	apu apu{ mmu };
+
+	start_square(mmu);
+	advance(mmu, apu::CYCLES_PER_SECOND / 16);
+
+	auto samples = drain(apu.get_samples());
+
+	ASSERT_NEAR(samples.size() / 2.0, apu::DEFAULT_SAMPLE_RATE / 16.0, 2.0);
+
+	std::int16_t left_peak = 0;
+	std::int16_t right_peak = 0;
+	std::size_t crossings = 0;
+
+	for (std::size_t index = blip_buffer::NUM_TAPS * 2; index < samples.size(); index += 2)
+	{
+		left_peak = std::max<std::int16_t>(left_peak, std::abs(samples[index]));
+		right_peak = std::max<std::int16_t>(right_peak, std::abs(samples[index + 1]));
+
+		if ((samples[index - 1] < 0) != (samples[index + 1] < 0))
+			++crossings;
+	}
+
+	EXPECT_EQ(left_peak, 0);
+	EXPECT_GT(right_peak, 15 * 8 * apu::VOLUME_UNIT / 4);
+
+	// (2048 - 0x700) * 4 cycles per duty step gives 512 Hz, two crossings per period.
+	EXPECT_NEAR(crossings, 64, 4);
+}
+
+TEST(apu, silent_when_disabled)
+{
+	mmu mmu;
+	apu apu{ mmu };
+
+	advance(mmu, apu::CYCLES_PER_SECOND / 16);
+
+	auto samples = drain(apu.get_samples());
+
+	EXPECT_FALSE(samples.empty());
+	EXPECT_TRUE(std::all_of(samples.begin(), samples.end(), [](std::int16_t sample) { return sample == 0; }));
+}
+
+TEST(rate_control, skew_follows_fill_level)
+{
+	rate_control rate;
+	std::uint64_t nominal = ppu::CYCLES_PER_SECOND / 100;
+
+	EXPECT_EQ(rate.advance(10000, 512, 1024), nominal);
+	EXPECT_DOUBLE_EQ(rate.get_speed(), 1.0);
+
+	EXPECT_NEAR(rate.advance(10000, 0, 1024), nominal * 1.005, 1.0);
+	EXPECT_DOUBLE_EQ(rate.get_speed(), 1.005);
+
+	EXPECT_NEAR(rate.advance(10000, 1024, 1024), nominal * 0.995, 1.0);
+	EXPECT_DOUBLE_EQ(rate.get_speed(), 0.995);
+
+	EXPECT_NEAR(rate.advance(10000, 768, 1024), nominal * 0.9975, 1.0);
+	EXPECT_EQ(rate.advance(1000000, 512, 1024), rate_control::MAX_ELAPSED_US * ppu::CYCLES_PER_SECOND / 1000000);
+}
+
+TEST(rate_control, ignores_unread_ring)
+{
+	rate_control rate;
+	std::uint64_t nominal = ppu::CYCLES_PER_SECOND / 100;
+
+	EXPECT_NEAR(rate.advance(10000, 1024, 1024), nominal * 0.995, 1.0);
+
+	// Nothing drained the ring between calls, as when audio is disabled or its device is gone.
+	for (int tick = 0; tick < 10; ++tick)
+	{
+		EXPECT_EQ(rate.advance(10000, 1024, 1024), nominal);
+		EXPECT_DOUBLE_EQ(rate.get_speed(), 1.0);
+	}
+
+	EXPECT_LT(rate.advance(10000, 1000, 1024), nominal);
+	EXPECT_LT(rate.get_speed(), 1.0);
+}
+
+TEST(rate_control, keeps_fractional_cycles)
+{
+	rate_control rate;
+	std::uint64_t total = 0;
+
+	for (int i = 0; i < 1000000; ++i)
+		total += rate.advance(1, 512, 1024);
+
+	EXPECT_NEAR(static_cast<double>(total), ppu::CYCLES_PER_SECOND, 1.0);
+}
+
+TEST(rate_control, settles_at_half_full)
+{
+	rate_control rate;
+	audio_ring ring{ 4096 };
+	std::vector<std::int16_t> samples(4096 * audio_ring::NUM_CHANNELS);
+	double produced = 0;
+
+	// The consumer drains 481 frames per 480 produced at nominal speed, within the controller's reach.
+	for (int tick = 0; tick < 20000; ++tick)
+	{
+		std::uint64_t cycles = rate.advance(10000, ring.get_available(), ring.get_capacity());
+
+		produced += cycles * 48000.0 / ppu::CYCLES_PER_SECOND;
+		ring.write(samples.data(), static_cast<std::size_t>(produced));
+		produced -= static_cast<std::size_t>(produced);
+
+		ring.read(samples.data(), 481);
+	}
+
+	EXPECT_NEAR(rate.get_speed(), 481.0 / 480.0, 0.0002);
+	EXPECT_GT(ring.get_available(), 0);
+	EXPECT_LT(ring.get_available(), ring.get_capacity());
+	EXPECT_EQ(ring.get_overruns(), 0);
+}
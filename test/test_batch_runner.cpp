@@ -0,0 +1,137 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <naive_gbe/batch_runner.hpp>
+#include <naive_gbe/headless_runner.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	void write_rom(std::string const& file_name)
+	{
+		std::ofstream rom{ file_name, std::ios::binary };
+		buffer data(0x8000, 0);
+		rom.write(reinterpret_cast<char const*>(data.data()), data.size());
+	}
+
+	void write_movie(std::string const& rom_path, std::string const& file_name)
+	{
+		std::error_code ec;
+		emulator emu;
+		cartridge cartridge;
+
+		ASSERT_TRUE(cartridge.load(rom_path, ec));
+		emu.set_cartridge(std::move(cartridge));
+		ASSERT_TRUE(emu.record_movie(ec));
+
+		headless_runner runner{ emu };
+
+		for (int frame = 0; frame < 90; ++frame)
+		{
+			emu.set_joypad(emulator::joypad_input::START, frame >= 30 && frame < 45);
+			runner.run_frame();
+		}
+
+		emu.stop_movie();
+		ASSERT_TRUE(emu.get_movie().save(file_name, ec));
+	}
+}
+
+TEST(batch_runner, parse_manifest)
+{
+	std::error_code ec;
+	batch_runner::job_list jobs;
+
+	std::string text =
+		"# rom frames [movie]\n"
+		"\n"
+		"tetris.gb 600\n"
+		"/roms/zelda.gb 0 zelda.gbm  # frames from the movie\n"
+		"C:\\roms\\mario.gb 100 \\movies\\mario.gbm\n";
+
+	ASSERT_TRUE(batch_runner::parse_manifest(text, "base", jobs, ec));
+	ASSERT_EQ(jobs.size(), 3);
+	EXPECT_EQ(jobs[0].rom_path_, "base/tetris.gb");
+	EXPECT_EQ(jobs[0].frames_, 600);
+	EXPECT_TRUE(jobs[0].movie_path_.empty());
+	EXPECT_EQ(jobs[1].rom_path_, "/roms/zelda.gb");
+	EXPECT_EQ(jobs[1].movie_path_, "base/zelda.gbm");
+	EXPECT_EQ(jobs[2].rom_path_, "C:\\roms\\mario.gb");
+	EXPECT_EQ(jobs[2].movie_path_, "\\movies\\mario.gbm");
+
+	for (auto bad : { "tetris.gb\n", "tetris.gb many\n", "tetris.gb 0\n", "tetris.gb 10 a.gbm extra\n" })
+	{
+		ec.clear();
+		EXPECT_FALSE(batch_runner::parse_manifest(bad, "", jobs, ec)) << bad;
+		EXPECT_EQ(ec, std::errc::invalid_argument);
+	}
+
+	EXPECT_EQ(jobs.size(), 3);
+}
+
+TEST(batch_runner, run_jobs)
+{
+	std::string rom_path = testing::TempDir() + "batch_runner_test.gb";
+	std::string movie_path = testing::TempDir() + "batch_runner_test.gbm";
+
+	write_rom(rom_path);
+	write_movie(rom_path, movie_path);
+
+	batch_runner::job_list jobs =
+	{
+		{ rom_path, "", 30 },
+		{ rom_path + ".missing", "", 30 },
+		{ rom_path, movie_path, 0 },
+		{ rom_path, "", 120 },
+		{ rom_path, movie_path, 40 },
+	};
+
+	batch_runner runner{ 2 };
+	std::size_t reported = 0;
+
+	EXPECT_EQ(runner.get_num_threads(), 2);
+
+	auto results = runner.run(jobs, [&reported](auto const&, auto const&) { ++reported; });
+
+	ASSERT_EQ(results.size(), jobs.size());
+	EXPECT_EQ(reported, jobs.size());
+
+	for (std::size_t index = 0; index < jobs.size(); ++index)
+	{
+		auto expected = batch_runner::run_job(jobs[index]);
+		auto const& result = results[index];
+
+		EXPECT_EQ(result.index_, index);
+		EXPECT_EQ(result.error_, expected.error_);
+		EXPECT_EQ(result.frames_, expected.frames_);
+		EXPECT_EQ(result.frame_hash_, expected.frame_hash_);
+		EXPECT_EQ(result.cycles_, expected.cycles_);
+	}
+
+	EXPECT_TRUE(results[1].error_);
+	EXPECT_EQ(results[2].frames_, 90);
+	EXPECT_TRUE(results[2].checked_);
+	EXPECT_FALSE(results[2].desync_);
+	EXPECT_FALSE(results[4].checked_);
+	EXPECT_GT(results[3].cycles_, results[0].cycles_);
+
+	batch_runner::job named{ "batch_runner_test.gb", "batch_runner_test.gbm", 0 };
+	auto line = batch_runner::to_json(named, results[2]);
+	EXPECT_EQ(line.find("{\"job\":2,\"rom\":\"batch_runner_test.gb\",\"movie\":\"batch_runner_test.gbm\",\"frames\":90,"), 0);
+	EXPECT_NE(line.find("\"desync\":false}"), std::string::npos);
+
+	line = batch_runner::to_json(jobs[1], results[1]);
+	EXPECT_NE(line.find("\"error\":\""), std::string::npos);
+	EXPECT_EQ(line.find("\"cycles\""), std::string::npos);
+
+	std::remove(rom_path.c_str());
+	std::remove(movie_path.c_str());
+}
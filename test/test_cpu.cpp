@@ -22,23 +22,17 @@ public:
 
 	void set_data(std::initializer_list<std::uint8_t> data)
 	{
-		std::size_t addr = 0x0000;
-		std::uint8_t* ptr = nullptr;
-
 		invalid_.assign(0x10000, 0);
 
-		addr = 0x0000;
-		ptr = invalid_.data();
-		while (addr < 0x10000)
-			memory_[addr++].set(ptr++, address::access_mode::READ_WRITE);
+		assign(0x0000, 0x10000, invalid_.data(), address::access_mode::READ_WRITE);
+		commit(0x0000, 0x10000);
 
+		std::copy(std::begin(data), std::end(data), std::begin(invalid_));
+	}
 
-		auto it1 = std::begin(data);
-		auto it2 = std::begin(memory_);
+private:
 
-		while (it1 != std::end(data) && it2 != std::end(memory_))
-			*it2++ = *it1++;
-	}
+	buffer	invalid_;
 };
 
 const std::vector<lr35902::r8> r8_registers =
@@ -1802,6 +1796,29 @@ TEST(instructions, op_ld_r8_r8)
 	}
 }
 
+TEST(instructions, op_ld_a_a)
+{
+	mmu_buf mmu;
+	ppu ppu{ mmu };
+	lr35902 cpu{ mmu, ppu };
+
+	mmu.set_data({
+		0x06, 0x01,			// LD B, 0x01
+		0x3e, 0x02,			// LD A, 0x02
+		0x7f,				// LD A, A
+		});
+
+	cpu.reset();
+
+	for (int step = 0; step < 3; ++step)
+		cpu.step();
+
+	EXPECT_EQ(cpu.get_register(lr35902::r8::A), 0x02);
+	EXPECT_EQ(cpu.get_register(lr35902::r8::B), 0x01);
+	EXPECT_EQ(cpu.get_register(lr35902::r16::PC), 5);
+	EXPECT_EQ(cpu.get_cycle(), 20);
+}
+
 TEST(instructions, op_nop)
 {
 	// NOP
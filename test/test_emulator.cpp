@@ -0,0 +1,57 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <naive_gbe/emulator.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	// The scheduler must follow the cpu back to cycle 0, or APU and DMA events stall until it catches up.
+	void expect_events_fire(emulator& emu)
+	{
+		auto& mmu = emu.get_mmu();
+		auto& scheduler = mmu.get_scheduler();
+
+		EXPECT_EQ(emu.get_cpu().get_cycle(), 0);
+		EXPECT_EQ(scheduler.get_cycle(), 0);
+		EXPECT_EQ(scheduler.get_event_cycle(scheduler::EVENT_APU), apu::CYCLES_PER_STEP);
+
+		emu.run_frame();
+
+		std::uint64_t cycle = emu.get_cpu().get_cycle();
+
+		EXPECT_GT(scheduler.get_event_cycle(scheduler::EVENT_APU), cycle);
+		EXPECT_LE(scheduler.get_event_cycle(scheduler::EVENT_APU), cycle + apu::CYCLES_PER_STEP);
+
+		mmu[ppu::IO_REG_DMA] = 0xc0;
+		EXPECT_TRUE(mmu.is_dma_active());
+
+		emu.run_frame();
+		EXPECT_FALSE(mmu.is_dma_active());
+	}
+}
+
+TEST(emulator, reload_resets_scheduler)
+{
+	emulator emu;
+	emu.set_cartridge(cartridge{ buffer(0x8000, 0) });
+
+	for (std::size_t frame = 0; frame < 200; ++frame)
+		emu.run_frame();
+
+	emu.get_mmu()[ppu::IO_REG_DMA] = 0xc0;
+	emu.set_cartridge(cartridge{ buffer(0x8000, 0) });
+	expect_events_fire(emu);
+
+	for (std::size_t frame = 0; frame < 200; ++frame)
+		emu.run_frame();
+
+	emu.get_mmu()[ppu::IO_REG_DMA] = 0xc0;
+	emu.set_bootstrap(buffer(0x100, 0));
+	expect_events_fire(emu);
+}
@@ -0,0 +1,170 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include <naive_gbe/emulator_thread.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	bool wait_for(emulator_thread& runner, std::function<bool(emulator_thread::status const&)> const& done)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+
+		while (std::chrono::steady_clock::now() < deadline)
+		{
+			runner.acquire_status();
+
+			if (done(runner.get_status()))
+				return true;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		}
+
+		return false;
+	}
+}
+
+TEST(emulator_thread, commands)
+{
+	emulator emu;
+	emulator_thread runner{ emu };
+
+	emu.set_cartridge(cartridge{ buffer(0x8000, 0) });
+	runner.start();
+	ASSERT_TRUE(runner.is_running());
+
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.cycle_ > 0; }));
+
+	ASSERT_TRUE(runner.set_joypad(emulator::joypad_input::A, true));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.joypad_.test(2); }));
+
+	ASSERT_TRUE(runner.pause());
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.paused_; }));
+	EXPECT_FALSE(runner.get_status().next_op_.empty());
+
+	std::size_t cycle = runner.get_status().cycle_;
+	std::this_thread::sleep_for(std::chrono::milliseconds{ 30 });
+	ASSERT_TRUE(wait_for(runner, [cycle](auto const& status) { return status.cycle_ == cycle; }));
+
+	ASSERT_TRUE(runner.reset());
+	ASSERT_TRUE(runner.resume());
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return !status.paused_; }));
+	EXPECT_TRUE(runner.get_status().next_op_.empty());
+
+	runner.stop();
+	EXPECT_FALSE(runner.is_running());
+	EXPECT_TRUE(emu.get_joypad().test(2));
+}
+
+TEST(emulator_thread, load_rom)
+{
+	std::string rom_path = testing::TempDir() + "emulator_thread_test.gb";
+	{
+		std::ofstream rom{ rom_path, std::ios::binary };
+		buffer data(0x8000, 0);
+		rom.write(reinterpret_cast<char const*>(data.data()), data.size());
+	}
+
+	emulator emu;
+	emulator_thread runner{ emu };
+
+	runner.start();
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.state_ == emulator::state::NO_CARTRIDGE; }));
+
+	ASSERT_TRUE(runner.load_rom(rom_path + ".missing"));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.loads_ == 1; }));
+	EXPECT_TRUE(runner.get_status().error_);
+	EXPECT_EQ(runner.get_status().state_, emulator::state::NO_CARTRIDGE);
+
+	ASSERT_TRUE(runner.load_rom(rom_path));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.loads_ == 2 && status.cycle_ > 0; }));
+	EXPECT_FALSE(runner.get_status().error_);
+	EXPECT_EQ(runner.get_status().state_, emulator::state::READY);
+
+	runner.stop();
+	std::remove(rom_path.c_str());
+}
+
+TEST(emulator_thread, queue_full)
+{
+	emulator emu;
+	emulator_thread runner{ emu };
+
+	for (std::size_t i = 0; i < emulator_thread::QUEUE_SIZE; ++i)
+		ASSERT_TRUE(runner.set_joypad(emulator::joypad_input::B, i % 2 == 0));
+
+	EXPECT_FALSE(runner.reset());
+
+	runner.start();
+	ASSERT_TRUE(wait_for(runner, [&runner](auto const&) { return runner.reset(); }));
+
+	runner.stop();
+	EXPECT_FALSE(emu.get_joypad().test(3));
+}
+
+TEST(emulator_thread, turbo)
+{
+	emulator emu;
+	emu.set_cartridge(cartridge{ buffer(0x8000, 0) });
+	emu.set_render_mode(ppu::RENDER_FULL);
+
+	emu.set_turbo(true);
+	EXPECT_EQ(emu.get_ppu().get_render_mode(), ppu::RENDER_INTERVAL);
+	EXPECT_EQ(emu.get_ppu().get_render_interval(), emulator::DEFAULT_TURBO_INTERVAL);
+
+	auto start = std::chrono::steady_clock::now();
+	std::size_t cycle = emu.get_cpu().get_cycle();
+
+	while (emu.get_cpu().get_cycle() - cycle < speed_meter::WINDOW_CYCLES * 2)
+		emu.run();
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	EXPECT_GE(elapsed, emulator::TURBO_SLICE_US / 1e6);
+	EXPECT_GT(emu.get_frame_time().count(), 0);
+	EXPECT_GT(emu.get_throughput(), 1.0);
+
+	emu.set_turbo(false);
+	EXPECT_FALSE(emu.is_turbo());
+	EXPECT_EQ(emu.get_ppu().get_render_mode(), ppu::RENDER_FULL);
+}
+
+TEST(emulator_thread, movie_commands)
+{
+	std::string file_name = testing::TempDir() + "emulator_thread_test.gbm";
+	emulator emu;
+	emulator_thread runner{ emu };
+
+	emu.set_cartridge(cartridge{ buffer(0x8000, 0) });
+	runner.start();
+
+	ASSERT_TRUE(runner.play_movie(file_name + ".missing"));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return bool(status.movie_error_); }));
+
+	ASSERT_TRUE(runner.record_movie());
+	ASSERT_TRUE(wait_for(runner, [](auto const& status)
+		{ return status.movie_mode_ == emulator::movie_mode::RECORDING && status.movie_frames_ > 10; }));
+	EXPECT_FALSE(runner.get_status().movie_error_);
+
+	ASSERT_TRUE(runner.stop_movie(file_name));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.movie_mode_ == emulator::movie_mode::OFF; }));
+	EXPECT_FALSE(runner.get_status().movie_error_);
+
+	ASSERT_TRUE(runner.play_movie(file_name));
+	ASSERT_TRUE(wait_for(runner, [](auto const& status) { return status.movie_mode_ == emulator::movie_mode::PLAYING; }));
+	EXPECT_FALSE(runner.get_status().movie_error_);
+
+	runner.stop();
+	std::remove(file_name.c_str());
+}
@@ -0,0 +1,115 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <naive_gbe/ppu.hpp>
+using namespace naive_gbe;
+
+TEST(frame_exchange, latest_frame)
+{
+	frame_exchange frames;
+
+	EXPECT_FALSE(frames.acquire());
+
+	frames.get_back().number_ = 1;
+	frames.publish();
+	frames.get_back().number_ = 2;
+	frames.publish();
+
+	EXPECT_EQ(frames.get_published(), 2);
+	EXPECT_TRUE(frames.acquire());
+	EXPECT_EQ(frames.get_front().number_, 2);
+	EXPECT_FALSE(frames.acquire());
+	EXPECT_EQ(frames.get_front().number_, 2);
+
+	frames.get_back().number_ = 3;
+	EXPECT_EQ(frames.get_front().number_, 2);
+	frames.publish();
+	EXPECT_TRUE(frames.acquire());
+	EXPECT_EQ(frames.get_front().number_, 3);
+}
+
+TEST(frame_exchange, concurrent_handoff)
+{
+	frame_exchange frames;
+	std::size_t const num_frames = 20000;
+
+	std::thread producer([&]
+	{
+		for (std::size_t number = 1; number <= num_frames; ++number)
+		{
+			auto& frame = frames.get_back();
+
+			frame.shades_.assign(64, static_cast<std::uint8_t>(number));
+			frame.number_ = number;
+			frames.publish();
+		}
+	});
+
+	std::size_t last = 0;
+	bool consistent = true;
+
+	while (last < num_frames)
+	{
+		if (!frames.acquire())
+			continue;
+
+		auto const& frame = frames.get_front();
+
+		for (auto shade : frame.shades_)
+			consistent &= shade == static_cast<std::uint8_t>(frame.number_);
+
+		consistent &= frame.number_ > last;
+		last = frame.number_;
+	}
+
+	producer.join();
+
+	EXPECT_TRUE(consistent);
+	EXPECT_EQ(frames.get_published(), num_frames);
+}
+
+TEST(frame_exchange, ppu_publishes_changed_frames)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	auto& frames = ppu.get_frames();
+
+	mmu[0x8010] = 0xff;
+	mmu[0x9800] = 0x01;
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x10 | 0x01;
+
+	std::size_t cycle = 0;
+	ppu.run(cycle);
+
+	cycle += ppu::CYCLES_PER_FRAME;
+	ppu.run(cycle);
+
+	ASSERT_TRUE(frames.acquire());
+	EXPECT_EQ(frames.get_front().number_, 1);
+	EXPECT_EQ(frames.get_front().shades_[0], 1);
+	EXPECT_TRUE(frames.get_front().rgba_.empty());
+
+	cycle += ppu::CYCLES_PER_FRAME;
+	ppu.run(cycle);
+
+	EXPECT_FALSE(frames.acquire());
+	EXPECT_EQ(frames.get_published(), 1);
+
+	ppu.set_output(ppu::OUTPUT_RGBA32, { 1, 2, 3, 4 });
+	cycle += ppu::CYCLES_PER_FRAME;
+	ppu.run(cycle);
+
+	ASSERT_TRUE(frames.acquire());
+	EXPECT_EQ(frames.get_front().number_, 3);
+	EXPECT_EQ(frames.get_front().rgba_[0], 2);
+	EXPECT_EQ(frames.get_front().rgba_[8], 1);
+}
@@ -0,0 +1,195 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include <naive_gbe/hash.hpp>
+#include <naive_gbe/headless_runner.hpp>
+using namespace naive_gbe;
+
+#ifndef NAIVE_GBE_TEST_DATA
+	#define NAIVE_GBE_TEST_DATA "../../../../test/data"
+#endif
+
+// Runs the boot ROM into a STOP, or into program when one is given; the boot ROM hands over at frame 332.
+static cartridge make_boot_cartridge(emulator& emu, buffer const& program = {})
+{
+	buffer rom(0x8000, 0);
+
+	for (std::uint16_t offset = 0; offset < 0x30; ++offset)
+		rom[0x104 + offset] = emu.get_mmu()[0xa8 + offset];
+
+	std::uint8_t checksum = 0;
+
+	for (std::size_t addr = 0x134; addr < 0x14d; ++addr)
+		checksum = checksum - rom[addr] - 1;
+
+	rom[0x14d] = checksum;
+
+	if (program.empty())
+	{
+		rom[0x100] = 0x10;							// STOP
+	}
+	else
+	{
+		rom[0x100] = 0xc3;							// JP 0x0150
+		rom[0x101] = 0x50;
+		rom[0x102] = 0x01;
+		std::copy(program.begin(), program.end(), rom.begin() + 0x150);
+	}
+
+	return cartridge{ std::move(rom) };
+}
+
+TEST(hash, xxhash64_vectors)
+{
+	std::string text = "Nobody inspects the spammish repetition";
+
+	EXPECT_EQ(hash64("", 0), 0xef46db3751d8e999ull);
+	EXPECT_EQ(hash64("a", 1), 0xd24ec4f1a98c6e5bull);
+	EXPECT_EQ(hash64("abc", 3), 0x44bc2cf5ad770999ull);
+	EXPECT_EQ(hash64(text.data(), text.size()), 0xfbcea83c8a378bf1ull);
+}
+
+TEST(headless_runner, joypad_register)
+{
+	emulator emu;
+	auto& mmu = emu.get_mmu();
+
+	mmu[emulator::IO_REG_P1] = 0x20;
+	mmu[mmu::IO_REG_IF] = 0x00;
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xef);
+
+	emu.set_joypad(emulator::joypad_input::DOWN, true);
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xe7);
+	EXPECT_EQ(mmu[mmu::IO_REG_IF] & mmu::INT_JOYPAD, mmu::INT_JOYPAD);
+
+	emu.set_joypad(emulator::joypad_input::A, true);
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xe7);
+
+	mmu[mmu::IO_REG_IF] = 0x00;
+	mmu[emulator::IO_REG_P1] = 0xef;
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xe7);
+	EXPECT_EQ(mmu[mmu::IO_REG_IF] & mmu::INT_JOYPAD, 0);
+
+	mmu[emulator::IO_REG_P1] = 0x10;
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xde);
+	EXPECT_EQ(mmu[mmu::IO_REG_IF] & mmu::INT_JOYPAD, mmu::INT_JOYPAD);
+
+	mmu[mmu::IO_REG_IF] = 0x00;
+	mmu[emulator::IO_REG_P1] = 0x30;
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xff);
+	mmu[emulator::IO_REG_P1] = 0x10;
+	EXPECT_EQ(mmu[mmu::IO_REG_IF] & mmu::INT_JOYPAD, mmu::INT_JOYPAD);
+
+	emu.set_joypad(emulator::joypad_input::A, false);
+	EXPECT_EQ(mmu[emulator::IO_REG_P1], 0xdf);
+}
+
+TEST(headless_runner, parse_script)
+{
+	headless_runner::input_script script;
+	std::error_code ec;
+
+	ASSERT_TRUE(headless_runner::parse_script("# boot\n10 START down\n\n12 START up # release\n", script, ec));
+	ASSERT_EQ(script.size(), 2);
+	EXPECT_EQ(script[0].frame_, 10);
+	EXPECT_EQ(script[0].input_, emulator::joypad_input::START);
+	EXPECT_TRUE(script[0].pressed_);
+	EXPECT_EQ(script[1].frame_, 12);
+	EXPECT_FALSE(script[1].pressed_);
+
+	EXPECT_FALSE(headless_runner::parse_script("10 TURBO down\n", script, ec));
+	EXPECT_EQ(ec, std::errc::invalid_argument);
+	EXPECT_FALSE(headless_runner::parse_script("START down\n", script, ec));
+	EXPECT_EQ(script.size(), 2);
+}
+
+TEST(headless_runner, bootstrap_golden_hashes)
+{
+	std::string file_name = std::string(NAIVE_GBE_TEST_DATA) + "/bootstrap.hashes";
+	headless_runner::input_script script;
+	std::error_code ec;
+
+	ASSERT_TRUE(headless_runner::parse_script("100 START down\n110 START up\n", script, ec));
+
+	for (std::size_t threads : { 0, 2 })
+	{
+		emulator emu;
+		emu.set_cartridge(make_boot_cartridge(emu));
+		emu.set_raster_threads(threads);
+
+		headless_runner runner{ emu };
+		auto hashes = runner.run(340, script);
+
+		ASSERT_EQ(hashes.size(), 340);
+		EXPECT_EQ(emu.get_cpu().get_state(), lr35902::state::STOPPED);
+
+		if (!threads && std::getenv("NAIVE_GBE_UPDATE_GOLDEN"))
+		{
+			ASSERT_TRUE(headless_runner::save_hashes(file_name, hashes, ec));
+		}
+
+		headless_runner::frame_hashes golden;
+
+		ASSERT_TRUE(headless_runner::load_hashes(file_name, golden, ec)) << ec.message();
+		ASSERT_EQ(golden.size(), hashes.size());
+
+		for (std::size_t frame = 0; frame < hashes.size(); ++frame)
+			EXPECT_EQ(hashes[frame], golden[frame]) << "frame " << frame << ", threads " << threads;
+	}
+}
+
+TEST(headless_runner, joypad_golden_hashes)
+{
+	std::string file_name = std::string(NAIVE_GBE_TEST_DATA) + "/joypad.hashes";
+	headless_runner::input_script script;
+	std::error_code ec;
+
+	// Shows the pressed keys through BGP; the logo left by the boot ROM uses color 1.
+	buffer program =
+	{
+		0x3e, 0x20, 0xe0, 0x00, 0xf0, 0x00,			// LD A, 0x20; LDH (0x00), A; LDH A, (0x00)
+		0x2f, 0xe6, 0x0f, 0x47,						// CPL; AND 0x0f; LD B, A
+		0x3e, 0x10, 0xe0, 0x00, 0xf0, 0x00,			// LD A, 0x10; LDH (0x00), A; LDH A, (0x00)
+		0x2f, 0xe6, 0x0f, 0xb0,						// CPL; AND 0x0f; OR B
+		0xe0, 0x47, 0x18, 0xe8,						// LDH (0x47), A; JR 0x0150
+	};
+
+	ASSERT_TRUE(headless_runner::parse_script("345 RIGHT down\n355 START down\n365 RIGHT up\n375 START up\n", script, ec));
+
+	emulator idle;
+	idle.set_cartridge(make_boot_cartridge(idle, program));
+
+	auto idle_hashes = headless_runner{ idle }.run(390, {});
+
+	emulator emu;
+	emu.set_cartridge(make_boot_cartridge(emu, program));
+
+	auto hashes = headless_runner{ emu }.run(390, script);
+
+	ASSERT_EQ(hashes.size(), 390);
+	EXPECT_EQ(hashes[340], idle_hashes[340]);
+	EXPECT_NE(hashes[350], idle_hashes[350]);
+	EXPECT_NE(hashes[360], hashes[350]);
+	EXPECT_NE(hashes[370], hashes[360]);
+	EXPECT_EQ(hashes[385], idle_hashes[385]);
+
+	if (std::getenv("NAIVE_GBE_UPDATE_GOLDEN"))
+	{
+		ASSERT_TRUE(headless_runner::save_hashes(file_name, hashes, ec));
+	}
+
+	headless_runner::frame_hashes golden;
+
+	ASSERT_TRUE(headless_runner::load_hashes(file_name, golden, ec)) << ec.message();
+	ASSERT_EQ(golden.size(), hashes.size());
+
+	for (std::size_t frame = 0; frame < hashes.size(); ++frame)
+		EXPECT_EQ(hashes[frame], golden[frame]) << "frame " << frame;
+}
@@ -0,0 +1,188 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <naive_gbe/lockstep_cpu.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	using r8 = lr35902::r8;
+
+	using r16 = lr35902::r16;
+
+	buffer make_bootstrap()
+	{
+		buffer bootstrap(0x100, 0x00);
+		bootstrap[0xfc] = 0x3e;		// LD A, 0x01
+		bootstrap[0xfd] = 0x01;
+		bootstrap[0xfe] = 0xe0;		// LDH (0x50), A
+		bootstrap[0xff] = 0x50;
+
+		return bootstrap;
+	}
+
+	std::uint8_t random_reg(std::mt19937& random)
+	{
+		std::uint8_t code = random() % 7;
+
+		return code == 6 ? 7 : code;
+	}
+
+	// B, C and D are never overwritten, so the joypad state read at the top keeps steering the lanes.
+	std::uint8_t random_dst(std::mt19937& random)
+	{
+		static const std::uint8_t codes[] = { 3, 4, 5, 7 };
+
+		return codes[random() % 4];
+	}
+
+	// Reads the joypad into B and C, then runs random register ops; conditional jumps split the lanes.
+	buffer make_rom(std::uint32_t seed)
+	{
+		std::mt19937 random{ seed };
+		buffer rom(0x8000, 0x00);
+		buffer code =
+		{
+			0x3e, 0x20, 0xe0, 0x00, 0xf0, 0x00, 0x47,		// LD A, 0x20; LDH (0x00), A; LDH A, (0x00); LD B, A
+			0x3e, 0x10, 0xe0, 0x00, 0xf0, 0x00, 0x4f,		// LD A, 0x10; LDH (0x00), A; LDH A, (0x00); LD C, A
+			0x80, 0x81, 0x57,								// ADD A, B; ADD A, C; LD D, A
+		};
+
+		static const std::uint8_t scalar_ops[] = { 0x03, 0x0b, 0x1b, 0x23, 0x2b, 0x07, 0x0f, 0x17, 0x1f, 0x27, 0x2f, 0x37, 0x3f };
+		static const std::uint8_t conditions[] = { 0x20, 0x28, 0x30, 0x38 };
+
+		while (code.size() < 0x2000)
+		{
+			switch (random() % 8)
+			{
+			case 0:
+				code.push_back(0x40 | random_dst(random) << 3 | random_reg(random));
+				break;
+			case 1:
+				code.push_back(0x80 | (random() % 8) << 3 | random_reg(random));
+				break;
+			case 2:
+				code.push_back(0xc6 | (random() % 8) << 3);
+				code.push_back(random() & 0xff);
+				break;
+			case 3:
+				code.push_back(0x04 | random_dst(random) << 3 | random() % 2);
+				break;
+			case 4:
+				code.push_back(0x06 | random_dst(random) << 3);
+				code.push_back(random() & 0xff);
+				break;
+			case 5:
+			{
+				std::uint8_t skip = 1 + random() % 3;
+
+				code.push_back(conditions[random() % 4]);
+				code.push_back(skip);
+
+				for (std::uint8_t i = 0; i < skip; ++i)
+					code.push_back(0x80 | random_reg(random));
+				break;
+			}
+			case 6:
+				if (random() % 2)
+					code.push_back(scalar_ops[random() % sizeof(scalar_ops)]);
+				else
+				{
+					code.push_back(0xcb);
+					code.push_back(0x30 | random_dst(random));
+				}
+				break;
+			default:
+				code.push_back(0x00);
+				code.push_back(0x18);
+				code.push_back(0x00);
+				break;
+			}
+		}
+
+		code.insert(code.end(), { 0xc3, 0x50, 0x01 });		// JP 0x0150
+
+		rom[0x100] = 0xc3;									// JP 0x0150
+		rom[0x101] = 0x50;
+		rom[0x102] = 0x01;
+		std::copy(code.begin(), code.end(), rom.begin() + 0x150);
+
+		return rom;
+	}
+
+	void set_joypad(emulator& emu, std::size_t keys)
+	{
+		for (std::uint8_t key = 0; key < 8; ++key)
+			emu.set_joypad(static_cast<emulator::joypad_input>(key), (keys >> key) & 1);
+	}
+}
+
+TEST(lockstep_cpu, matches_independent_emulators)
+{
+	std::size_t num_lanes = 80;
+	buffer rom = make_rom(1234);
+
+	for (auto isa : { lockstep_cpu::isa::SCALAR, lockstep_cpu::isa::SSE2 })
+	{
+		if (!lockstep_cpu::is_supported(isa))
+			continue;
+
+		lockstep_cpu lockstep{ num_lanes, rom, isa };
+		std::vector<std::unique_ptr<emulator>> expected;
+
+		ASSERT_EQ(lockstep.get_isa(), isa);
+		ASSERT_EQ(lockstep.get_num_lanes(), num_lanes);
+
+		for (std::size_t lane = 0; lane < num_lanes; ++lane)
+		{
+			expected.push_back(std::make_unique<emulator>());
+			expected.back()->set_cartridge(cartridge{ buffer{ rom } });
+			expected.back()->set_bootstrap(make_bootstrap());
+			lockstep.get_emulator(lane).set_bootstrap(make_bootstrap());
+		}
+
+		for (std::size_t frame = 0; frame < 20; ++frame)
+		{
+			for (std::size_t lane = 0; lane < num_lanes; ++lane)
+			{
+				std::size_t keys = frame < 10 ? lane * 37 : lane * 11 + frame;
+
+				set_joypad(*expected[lane], keys);
+				set_joypad(lockstep.get_emulator(lane), keys);
+				expected[lane]->run_frame();
+			}
+
+			lockstep.run_frame();
+
+			for (std::size_t lane = 0; lane < num_lanes; ++lane)
+			{
+				auto& cpu = expected[lane]->get_cpu();
+
+				for (auto reg : { r8::A, r8::F, r8::B, r8::C, r8::D, r8::E, r8::H, r8::L })
+					ASSERT_EQ(lockstep.get_register(lane, reg), cpu.get_register(reg)) << "lane " << lane << " frame " << frame;
+
+				ASSERT_EQ(lockstep.get_register(lane, r16::SP), cpu.get_register(r16::SP));
+				ASSERT_EQ(lockstep.get_register(lane, r16::PC), cpu.get_register(r16::PC));
+				ASSERT_EQ(lockstep.get_cycle(lane), cpu.get_cycle());
+				ASSERT_EQ(lockstep.get_emulator(lane).get_cpu().get_registers(), cpu.get_registers());
+			}
+		}
+
+		for (std::size_t lane = 0; lane < num_lanes; ++lane)
+			EXPECT_EQ(lockstep.get_emulator(lane).get_ppu().get_frame_hash(), expected[lane]->get_ppu().get_frame_hash());
+
+		auto const& statistics = lockstep.get_statistics();
+
+		EXPECT_GT(statistics.scalar_steps_, 0);
+		EXPECT_GT(statistics.vector_steps_, statistics.scalar_steps_);
+		EXPECT_LT(statistics.groups_, statistics.vector_steps_);
+	}
+}
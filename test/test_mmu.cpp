@@ -0,0 +1,210 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include <naive_gbe/mmu.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	cartridge make_cartridge(std::uint8_t type, std::uint8_t ram_size)
+	{
+		buffer data(0x8000, 0);
+
+		data[cartridge::HEADER_TYPE] = type;
+		data[cartridge::HEADER_RAM_SIZE] = ram_size;
+
+		return cartridge{ std::move(data) };
+	}
+}
+
+TEST(save_ram, volatile_without_battery)
+{
+	mmu mmu;
+
+	mmu.set_cartridge(make_cartridge(0x08, 0x02));
+
+	auto& ram = mmu.get_save_ram();
+
+	EXPECT_EQ(ram.get_size(), 0x2000);
+	EXPECT_FALSE(ram.is_mapped());
+
+	mmu[0xa000] = 0x12;
+	mmu[0xbfff] = 0x34;
+
+	EXPECT_EQ(mmu[0xa000], 0x12);
+	EXPECT_EQ(mmu[0xbfff], 0x34);
+	EXPECT_EQ(ram.get_dirty_pages(), 0);
+}
+
+TEST(save_ram, persisted_through_mapping)
+{
+	std::string file_name = testing::TempDir() + "naive_gbe_save_ram.sav";
+	std::remove(file_name.c_str());
+
+	{
+		mmu mmu;
+		std::error_code ec;
+
+		mmu.set_cartridge(make_cartridge(0x03, 0x02));
+
+		ASSERT_TRUE(mmu.load_save_ram(file_name, ec));
+
+		auto& ram = mmu.get_save_ram();
+
+		EXPECT_TRUE(ram.is_mapped());
+		EXPECT_EQ(ram.get_dirty_pages(), 0);
+
+		mmu[0xa000] = 0xaa;
+		mmu[0xa001] = 0xbb;
+		mmu[0xbfff] = 0xcc;
+
+		EXPECT_GT(ram.get_dirty_pages(), 0);
+
+		ram.set_flush_interval(100);
+		ram.update(50);
+		EXPECT_GT(ram.get_dirty_pages(), 0);
+
+		ram.update(150);
+		EXPECT_EQ(ram.get_dirty_pages(), 0);
+
+		mmu.reset();
+		EXPECT_EQ(mmu[0xa000], 0xaa);
+	}
+
+	{
+		mmu mmu;
+		std::error_code ec;
+
+		mmu.set_cartridge(make_cartridge(0x03, 0x02));
+
+		ASSERT_TRUE(mmu.load_save_ram(file_name, ec));
+
+		EXPECT_EQ(mmu[0xa000], 0xaa);
+		EXPECT_EQ(mmu[0xa001], 0xbb);
+		EXPECT_EQ(mmu[0xbfff], 0xcc);
+	}
+
+	std::remove(file_name.c_str());
+}
+
+TEST(dma, bulk_transfer_to_oam)
+{
+	mmu mmu;
+
+	for (std::uint16_t offset = 0; offset < mmu::OAM_SIZE; ++offset)
+		mmu[0xc100 + offset] = static_cast<std::uint8_t>(offset + 1);
+
+	mmu[0xff80] = 0x55;
+	mmu[0xff46] = 0xc1;
+
+	EXPECT_TRUE(mmu.is_dma_active());
+
+	EXPECT_EQ(mmu[0xc100], 0xff);
+	EXPECT_EQ(mmu[0xfe00], 0xff);
+	EXPECT_EQ(mmu[0xff80], 0x55);
+
+	mmu[0xc100] = 0x00;
+	mmu[0xff81] = 0x66;
+	EXPECT_EQ(mmu[0xff81], 0x66);
+
+	mmu.get_scheduler().run(mmu::DMA_CYCLES - 1);
+	EXPECT_TRUE(mmu.is_dma_active());
+
+	mmu.get_scheduler().run(mmu::DMA_CYCLES);
+	EXPECT_FALSE(mmu.is_dma_active());
+
+	EXPECT_EQ(mmu[0xc100], 0x01);
+
+	for (std::uint16_t offset = 0; offset < mmu::OAM_SIZE; ++offset)
+		EXPECT_EQ(mmu[0xfe00 + offset], offset + 1);
+}
+
+TEST(watchpoints, page_trap)
+{
+	mmu mmu;
+	std::vector<mmu::watch_event> events;
+	std::uint16_t pc = 0x1234;
+
+	mmu.set_pc_source([&pc] { return pc; });
+	mmu.get_scheduler().run(100);
+
+	auto id = mmu.add_watchpoint(0xc010, 0xc01f, mmu::WATCH_WRITE,
+		[&events](mmu::watch_event const& event) { events.push_back(event); });
+
+	mmu[0xc00f] = 0x01;
+	mmu[0xc020] = 0x02;
+	EXPECT_EQ(mmu[0xc010], 0x00);
+	EXPECT_TRUE(events.empty());
+
+	mmu[0xc010] = 0xab;
+	ASSERT_EQ(events.size(), 1);
+	EXPECT_EQ(events[0].addr_, 0xc010);
+	EXPECT_EQ(events[0].value_, 0xab);
+	EXPECT_EQ(events[0].pc_, 0x1234);
+	EXPECT_EQ(events[0].cycle_, 100);
+	EXPECT_EQ(events[0].access_, mmu::WATCH_WRITE);
+	EXPECT_EQ(mmu[0xc010], 0xab);
+	EXPECT_EQ(mmu[0xe010], 0xab);
+
+	mmu.add_watchpoint(0xff80, 0xff80, mmu::WATCH_READ,
+		[&events](mmu::watch_event const& event) { events.push_back(event); });
+
+	mmu[0xff80] = 0x42;
+	EXPECT_EQ(events.size(), 1);
+	EXPECT_EQ(mmu[0xff80], 0x42);
+	ASSERT_EQ(events.size(), 2);
+	EXPECT_EQ(events[1].access_, mmu::WATCH_READ);
+	EXPECT_EQ(events[1].value_, 0x42);
+
+	mmu.reset();
+	mmu[0xc01f] = 0xcd;
+	EXPECT_EQ(events.size(), 3);
+
+	mmu.remove_watchpoint(id);
+	mmu[0xc01f] = 0xef;
+	EXPECT_EQ(events.size(), 3);
+	EXPECT_EQ(mmu[0xc01f], 0xef);
+}
+
+#if NAIVE_GBE_HEATMAP
+TEST(heatmap, counts_accesses)
+{
+	mmu mmu;
+	buffer rom(0x8000, 0);
+
+	rom[0x4100] = 0x3c;
+	mmu.set_cartridge(cartridge{ std::move(rom) });
+	mmu[0xff50] = 0x01;
+
+	auto& heatmap = mmu.get_heatmap();
+	heatmap.clear();
+
+	mmu[0xc000] = 0x01;
+	mmu[0xc000] = 0x02;
+	EXPECT_EQ(mmu[0xc000], 0x02);
+	EXPECT_EQ(mmu.fetch(0x4100), 0x3c);
+
+	EXPECT_EQ(heatmap.get(0xc000, heatmap::WRITE), 2);
+	EXPECT_EQ(heatmap.get(0xc000, heatmap::READ), 1);
+	EXPECT_EQ(heatmap.get(0x4100, heatmap::EXECUTE), 1);
+	EXPECT_EQ(heatmap.get(0x4100, heatmap::READ), 0);
+
+	ASSERT_EQ(heatmap.get_num_rom_banks(), 2);
+	EXPECT_EQ(heatmap.get_rom(0x4100, heatmap::EXECUTE), 1);
+	EXPECT_EQ(heatmap.get_rom(0xc000, heatmap::WRITE), 0);
+
+	std::error_code ec;
+	std::string file_name = testing::TempDir() + "naive_gbe_heatmap.ppm";
+
+	EXPECT_TRUE(heatmap.save_rom_bank_ppm(file_name, 1, heatmap::LINE_SIZE, ec));
+	EXPECT_FALSE(heatmap.save_rom_bank_ppm(file_name, 2, heatmap::LINE_SIZE, ec));
+	std::remove(file_name.c_str());
+}
+#endif
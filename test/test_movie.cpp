@@ -0,0 +1,200 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <naive_gbe/headless_runner.hpp>
+#include <naive_gbe/movie.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	// Counts polls with A held into 0xc000, so the input stream changes the memory contents.
+	void load_input_counter(emulator& emu)
+	{
+		buffer bootstrap(0x100, 0x00);
+		bootstrap[0xfc] = 0x3e;		// LD A, 0x01
+		bootstrap[0xfd] = 0x01;
+		bootstrap[0xfe] = 0xe0;		// LDH (0x50), A
+		bootstrap[0xff] = 0x50;
+
+		buffer rom(0x8000, 0x00);
+		std::uint8_t program[] =
+		{
+			0x21, 0x00, 0xc0,		// LD HL, 0xc000
+			0x3e, 0x10,				// LD A, 0x10
+			0xe0, 0x00,				// LDH (0x00), A
+			0xf0, 0x00,				// LDH A, (0x00)
+			0xe6, 0x01,				// AND 0x01
+			0x20, 0x01,				// JR NZ, +1
+			0x34,					// INC (HL)
+			0x18, 0xf3,				// JR 0x0103
+		};
+
+		std::copy(std::begin(program), std::end(program), rom.begin() + 0x100);
+
+		emu.set_cartridge(cartridge{ std::move(rom) });
+		emu.set_bootstrap(std::move(bootstrap));
+	}
+
+	struct frame_state
+	{
+		std::size_t		cycle_		= 0;
+		std::uint8_t	counter_	= 0;
+
+		bool operator==(frame_state const& rhs) const
+		{
+			return cycle_ == rhs.cycle_ && counter_ == rhs.counter_;
+		}
+	};
+
+	frame_state get_state(emulator& emu)
+	{
+		return { emu.get_cpu().get_cycle(), emu.get_mmu()[0xc000] };
+	}
+}
+
+TEST(movie, run_length_encoding)
+{
+	movie movie;
+	movie::anchor anchor;
+	anchor.rom_hash_ = 0x1234;
+
+	movie.clear(anchor);
+
+	for (int frame = 0; frame < 1000; ++frame)
+		movie.append(frame >= 300 && frame < 310 ? 0x04 : 0x00);
+
+	ASSERT_EQ(movie.get_runs().size(), 3);
+	EXPECT_EQ(movie.get_runs()[1].input_, 0x04);
+	EXPECT_EQ(movie.get_runs()[1].length_, 10);
+	EXPECT_EQ(movie.get_num_frames(), 1000);
+
+	movie::cursor cursor;
+	std::uint8_t input = 0;
+	std::size_t pressed = 0;
+
+	while (movie.next(cursor, input))
+		pressed += input == 0x04;
+
+	EXPECT_EQ(pressed, 10);
+
+	std::string file_name = testing::TempDir() + "test_movie.gbm";
+	std::error_code ec;
+
+	movie.set_result({ 42, 0xabcd });
+	ASSERT_TRUE(movie.save(file_name, ec)) << ec.message();
+
+	std::ifstream ifs(file_name, std::ios::binary | std::ios::ate);
+	EXPECT_LT(static_cast<std::size_t>(ifs.tellg()), 80);
+	ifs.close();
+
+	naive_gbe::movie loaded;
+	ASSERT_TRUE(loaded.load(file_name, ec)) << ec.message();
+	EXPECT_EQ(loaded.get_anchor().rom_hash_, 0x1234);
+	EXPECT_EQ(loaded.get_result().cycle_, 42);
+	EXPECT_EQ(loaded.get_result().frame_hash_, 0xabcd);
+	EXPECT_EQ(loaded.get_num_frames(), 1000);
+	ASSERT_EQ(loaded.get_runs().size(), 3);
+	EXPECT_EQ(loaded.get_runs()[2].length_, 690);
+
+	{
+		std::ofstream ofs(file_name, std::ios::binary | std::ios::app);
+		ofs.put(0x00);
+	}
+
+	EXPECT_FALSE(loaded.load(file_name, ec));
+	EXPECT_EQ(ec, std::errc::invalid_argument);
+	EXPECT_FALSE(loaded.load(file_name + ".missing", ec));
+
+	std::remove(file_name.c_str());
+}
+
+TEST(movie, exact_playback)
+{
+	emulator recorder;
+	load_input_counter(recorder);
+
+	std::error_code ec;
+	ASSERT_TRUE(recorder.record_movie(ec));
+
+	std::vector<frame_state> expected;
+
+	for (std::size_t frame = 0; frame < 300; ++frame)
+	{
+		bool pressed = (frame >= 40 && frame < 100) || (frame >= 200 && frame < 203);
+
+		if (pressed != recorder.get_joypad().test(2))
+		{
+			recorder.set_joypad(emulator::joypad_input::A, pressed);
+
+			// Input is latched at the start of the next frame while recording.
+			EXPECT_NE(recorder.get_joypad().test(2), pressed);
+		}
+
+		recorder.run_frame();
+		expected.push_back(get_state(recorder));
+	}
+
+	recorder.stop_movie();
+
+	auto const& recorded = recorder.get_movie();
+
+	EXPECT_EQ(recorder.get_movie_mode(), emulator::movie_mode::OFF);
+	EXPECT_EQ(recorded.get_num_frames(), 300);
+	EXPECT_EQ(recorded.get_runs().size(), 5);
+	EXPECT_EQ(recorded.get_result().cycle_, expected.back().cycle_);
+	EXPECT_EQ(expected[39].counter_, 0);
+	EXPECT_NE(expected[40].counter_, 0);
+	EXPECT_NE(expected[202].counter_, expected[199].counter_);
+
+	std::string file_name = testing::TempDir() + "test_playback.gbm";
+	ASSERT_TRUE(recorded.save(file_name, ec)) << ec.message();
+
+	movie loaded;
+	ASSERT_TRUE(loaded.load(file_name, ec)) << ec.message();
+	std::remove(file_name.c_str());
+
+	emulator player;
+	load_input_counter(player);
+	ASSERT_TRUE(player.play_movie(loaded, ec)) << ec.message();
+
+	std::vector<frame_state> played;
+
+	while (played.size() < loaded.get_num_frames())
+	{
+		player.run_frame();
+		played.push_back(get_state(player));
+	}
+
+	EXPECT_EQ(played, expected);
+
+	player.run_frame();
+	EXPECT_EQ(player.get_movie_mode(), emulator::movie_mode::OFF);
+
+	headless_runner runner{ player };
+	headless_runner::frame_hashes hashes;
+
+	ASSERT_TRUE(runner.play(loaded, hashes, ec)) << ec.message();
+	EXPECT_EQ(hashes.size(), 300);
+	EXPECT_EQ(get_state(player), expected.back());
+
+	movie empty;
+	empty.clear(loaded.get_anchor());
+	empty.set_result({ 42, 0xabcd });
+
+	EXPECT_FALSE(runner.play(empty, hashes, ec));
+	EXPECT_EQ(ec, std::errc::state_not_recoverable);
+	EXPECT_TRUE(hashes.empty());
+
+	emulator other;
+	other.set_cartridge(cartridge{ buffer(0x8000, 0x00) });
+	EXPECT_FALSE(other.play_movie(loaded, ec));
+	EXPECT_EQ(ec, std::errc::invalid_argument);
+}
@@ -8,6 +8,7 @@
 
 #include <naive_gbe/benchmark.hpp>
 #include <naive_gbe/emulator.hpp>
+#include <naive_gbe/lockstep_cpu.hpp>
 using namespace naive_gbe;
 
 #ifdef _DEBUG
@@ -57,3 +58,257 @@ TEST(DISABLED_performance, bootstrap)
 	EXPECT_EQ(cpu.get_register(lr35902::r16::PC), 0x0101);
 	//EXPECT_LT(result.average, baseline.average * BASELINE_MUL_FACTOR);
 }
+
+TEST(DISABLED_performance, reset)
+{
+	emulator emu;
+
+	emu.set_cartridge({
+		0x10,				// STOP
+	});
+
+	std::size_t num_samples = 10000;
+	benchmark<std::chrono::nanoseconds> b{ num_samples };
+
+	auto result = b.run("reset", [&]
+	{
+		emu.reset();
+	});
+
+	std::cout << result << '\n';
+
+	EXPECT_EQ(emu.get_cpu().get_cycle(), 0);
+	EXPECT_EQ(emu.get_mmu()[0x0000], 0x31);
+	EXPECT_LT(result.average, 1000);
+}
+
+TEST(DISABLED_performance, pixel_kernels)
+{
+	std::vector<std::uint8_t> data(ppu::NUM_TILES * ppu::TILE_SIZE);
+	for (std::size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<std::uint8_t>(i * 37);
+
+	std::size_t rows = data.size() / 2;
+	std::vector<std::uint8_t> colors(rows * 8);
+	std::vector<std::uint8_t> shades(colors.size());
+	std::vector<std::uint32_t> pixels(colors.size());
+	pixel_kernels::rgba_palette palette = { 0xffffffff, 0xffaaaaaa, 0xff555555, 0xff000000 };
+
+	std::size_t num_samples = 1000;
+	benchmark<std::chrono::nanoseconds> b{ num_samples };
+	double scalar_total = 0.0;
+
+	for (auto isa : { pixel_kernels::isa::SCALAR, pixel_kernels::isa::SSE2, pixel_kernels::isa::AVX2 })
+	{
+		if (!pixel_kernels::is_supported(isa))
+			continue;
+
+		pixel_kernels kernels{ isa };
+
+		auto decode = b.run("decode", [&] { kernels.decode(data.data(), rows, colors.data()); });
+		auto map = b.run("map", [&] { kernels.map(colors.data(), colors.size(), 0xe4, shades.data()); });
+		auto expand = b.run("expand", [&] { kernels.expand(shades.data(), shades.size(), palette, pixels.data()); });
+
+		std::cout << "isa " << static_cast<int>(isa) << '\n'
+			<< decode << '\n' << map << '\n' << expand << '\n';
+
+		double total = decode.average + map.average + expand.average;
+
+		if (isa == pixel_kernels::isa::SCALAR)
+			scalar_total = total;
+		else
+			EXPECT_LT(total, scalar_total);
+	}
+}
+
+TEST(DISABLED_performance, apu)
+{
+	mmu mmu;
+	apu apu{ mmu };
+	auto& scheduler = mmu.get_scheduler();
+	std::vector<std::int16_t> samples(audio_ring::DEFAULT_CAPACITY * audio_ring::NUM_CHANNELS);
+
+	mmu.write(apu::IO_REG_NR52, 0x80);
+	mmu.write(apu::IO_REG_NR50, 0x77);
+	mmu.write(apu::IO_REG_NR51, 0xff);
+	mmu.write(apu::IO_REG_NR11, 0x80);
+	mmu.write(apu::IO_REG_NR12, 0xf0);
+	mmu.write(apu::IO_REG_NR14, 0x87);
+	mmu.write(apu::IO_REG_NR21, 0x40);
+	mmu.write(apu::IO_REG_NR22, 0xf0);
+	mmu.write(apu::IO_REG_NR24, 0x86);
+	mmu.write(apu::IO_REG_NR30, 0x80);
+	mmu.write(apu::IO_REG_NR32, 0x20);
+	mmu.write(apu::IO_REG_NR34, 0x87);
+	mmu.write(apu::IO_REG_NR42, 0xf0);
+	mmu.write(apu::IO_REG_NR43, 0x10);
+	mmu.write(apu::IO_REG_NR44, 0x80);
+
+	for (std::uint16_t addr = apu::IO_REG_WAVE_FIRST; addr <= apu::IO_REG_WAVE_LAST; ++addr)
+		mmu.write(addr, static_cast<std::uint8_t>(addr * 0x1f));
+
+	std::size_t num_samples = 10;
+	benchmark<std::chrono::microseconds> b{ num_samples };
+
+	auto result = b.run("apu", [&]
+	{
+		std::uint64_t last = scheduler.get_cycle() + apu::CYCLES_PER_SECOND;
+
+		for (std::uint64_t cycle = scheduler.get_cycle(); cycle < last; cycle += 16)
+		{
+			scheduler.run(cycle);
+
+			if (!(cycle & 0xffff))
+				apu.get_samples().read(samples.data(), audio_ring::DEFAULT_CAPACITY);
+		}
+	});
+
+	std::cout << result << '\n';
+
+	EXPECT_TRUE(apu.is_channel_on(apu::CHANNEL_NOISE));
+	EXPECT_LT(result.average, 2e4);
+}
+
+TEST(DISABLED_performance, audio_kernels)
+{
+	std::size_t count = 4800;
+	std::vector<std::int16_t> data(count * audio_kernels::NUM_CHANNELS);
+	std::vector<std::int16_t> out(count * 2);
+
+	for (std::size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<std::int16_t>((i * 7919) % 16384 - 8192);
+
+	audio_kernels::channel_samples channels;
+	for (std::size_t ch = 0; ch < audio_kernels::NUM_CHANNELS; ++ch)
+		channels[ch] = data.data() + ch * count;
+
+	audio_kernels::mix_gains gains = { 8, 8, 8, 8, 8, 8, 8, 8 };
+
+	std::size_t num_samples = 1000;
+	benchmark<std::chrono::nanoseconds> b{ num_samples };
+	double scalar_rate = 0.0;
+
+	for (auto isa : { audio_kernels::isa::SCALAR, audio_kernels::isa::SSE2, audio_kernels::isa::AVX2 })
+	{
+		if (!audio_kernels::is_supported(isa))
+			continue;
+
+		audio_kernels kernels{ isa };
+
+		auto mix = b.run("mix", [&] { kernels.mix(channels, count, gains, out.data()); });
+		double rate = count * 1e9 / mix.average;
+
+		std::cout << "isa " << static_cast<int>(isa) << '\n'
+			<< mix << '\n' << "samples per second " << rate << '\n';
+
+		if (isa == audio_kernels::isa::SCALAR)
+			scalar_rate = rate;
+		else
+			EXPECT_GT(rate, scalar_rate);
+	}
+}
+
+TEST(DISABLED_performance, lockstep_cpu)
+{
+	buffer bootstrap(0x100, 0x00);
+	bootstrap[0xfc] = 0x3e;		// LD A, 0x01
+	bootstrap[0xfd] = 0x01;
+	bootstrap[0xfe] = 0xe0;		// LDH (0x50), A
+	bootstrap[0xff] = 0x50;
+
+	buffer rom(0x8000, 0x00);
+	std::uint8_t program[] =
+	{
+		0x21, 0x00, 0xc0,			// LD HL, 0xc000
+		0x3e, 0x20,					// LD A, 0x20
+		0xe0, 0x00,					// LDH (0x00), A
+		0xf0, 0x00,					// LDH A, (0x00)
+		0x47,						// LD B, A
+		0x78,						// LD A, B
+		0x81,						// ADD A, C
+		0xaa,						// XOR D
+		0x4f,						// LD C, A
+		0x14,						// INC D
+		0x1d,						// DEC E
+		0xe6, 0x0f,					// AND 0x0f
+		0xfe, 0x07,					// CP 0x07
+		0x20, 0x01,					// JR NZ, +1
+		0x04,						// INC B
+		0x22,						// LD (HL+), A
+		0x7c,						// LD A, H
+		0xfe, 0xd0,					// CP 0xd0
+		0x20, 0xed,					// JR NZ, 0x015a
+		0x21, 0x00, 0xc0,			// LD HL, 0xc000
+		0x18, 0xe8,					// JR 0x015a
+	};
+
+	rom[0x100] = 0xc3;				// JP 0x0150
+	rom[0x101] = 0x50;
+	rom[0x102] = 0x01;
+	std::copy(std::begin(program), std::end(program), rom.begin() + 0x150);
+
+	std::size_t num_frames = 30;
+	benchmark<std::chrono::microseconds> b{ 1 };
+
+	for (std::size_t num_lanes : { 64, 256 })
+	{
+		// Identical input keeps every lane on one pc, per lane input splits them on the JR NZ.
+		for (bool diverged : { false, true })
+		{
+			auto set_input = [&bootstrap, diverged](emulator& emu, std::size_t lane)
+			{
+				emu.set_bootstrap(buffer{ bootstrap });
+				emu.set_joypad(emulator::joypad_input::LEFT, diverged && lane % 2);
+				emu.set_joypad(emulator::joypad_input::DOWN, diverged && lane % 3);
+			};
+
+			std::vector<std::unique_ptr<emulator>> emulators;
+
+			for (std::size_t lane = 0; lane < num_lanes; ++lane)
+			{
+				emulators.push_back(std::make_unique<emulator>());
+				emulators.back()->set_cartridge(cartridge{ buffer{ rom } });
+				set_input(*emulators.back(), lane);
+			}
+
+			auto independent = b.run("independent", [&]
+			{
+				for (std::size_t frame = 0; frame < num_frames; ++frame)
+				{
+					for (auto& emu : emulators)
+						emu->run_frame();
+				}
+			});
+
+			std::cout << independent << '\n' << num_lanes << " lanes, diverged " << diverged
+				<< ", independent frames per second " << num_lanes * num_frames * 1e6 / independent.average << '\n';
+
+			for (auto isa : { lockstep_cpu::isa::SCALAR, lockstep_cpu::isa::SSE2 })
+			{
+				if (!lockstep_cpu::is_supported(isa))
+					continue;
+
+				lockstep_cpu lockstep{ num_lanes, rom, isa };
+
+				for (std::size_t lane = 0; lane < num_lanes; ++lane)
+					set_input(lockstep.get_emulator(lane), lane);
+
+				auto result = b.run("lockstep", [&]
+				{
+					for (std::size_t frame = 0; frame < num_frames; ++frame)
+						lockstep.run_frame();
+				});
+
+				auto const& statistics = lockstep.get_statistics();
+
+				std::cout << result << '\n' << "isa " << static_cast<int>(isa)
+					<< ", lockstep frames per second " << num_lanes * num_frames * 1e6 / result.average
+					<< ", lanes per group " << static_cast<double>(statistics.vector_steps_) / statistics.groups_
+					<< ", scalar steps " << statistics.scalar_steps_ << '\n';
+
+				EXPECT_EQ(lockstep.get_cycle(num_lanes - 1), emulators.back()->get_cpu().get_cycle());
+				EXPECT_EQ(lockstep.get_register(num_lanes - 1, lr35902::r8::A), emulators.back()->get_cpu().get_register(lr35902::r8::A));
+			}
+		}
+	}
+}
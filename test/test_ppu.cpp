@@ -0,0 +1,488 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <naive_gbe/cpu.hpp>
+using namespace naive_gbe;
+
+void write_tile(mmu& mmu, std::uint16_t addr, std::uint8_t lo, std::uint8_t hi)
+{
+	for (std::uint16_t row = 0; row < 8; ++row)
+	{
+		mmu[addr + row * 2] = lo;
+		mmu[addr + row * 2 + 1] = hi;
+	}
+}
+
+std::uint8_t get_pixel(ppu const& ppu, std::size_t x, std::size_t y)
+{
+	return ppu.get_video_ram()[y * ppu::SCREEN_WIDTH + x];
+}
+
+TEST(ppu, mode_timing)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	mmu[mmu::IO_REG_IF] = 0x00;
+	mmu[ppu::IO_REG_LYC] = 0x02;
+	mmu[ppu::IO_REG_LCDC] = 0x80;
+
+	ppu.run(0);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_OAM_SCAN);
+	EXPECT_EQ(mmu[ppu::IO_REG_LCDS] & 0x03, ppu::MODE_OAM_SCAN);
+
+	ppu.run(ppu::CYCLES_PER_OAM_SCAN);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_TRANSFER);
+
+	ppu.run(ppu::CYCLES_PER_OAM_SCAN + ppu::CYCLES_PER_TRANSFER);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_HBLANK);
+	EXPECT_EQ(mmu[ppu::IO_REG_LY], 0);
+
+	ppu.run(ppu::CYCLES_PER_LINE * 2);
+	EXPECT_EQ(mmu[ppu::IO_REG_LY], 2);
+	EXPECT_TRUE(mmu[ppu::IO_REG_LCDS] & 0x04);
+
+	ppu.run(ppu::CYCLES_PER_LINE * ppu::SCREEN_HEIGHT);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_VBLANK);
+	EXPECT_EQ(ppu.get_frame(), 1);
+	EXPECT_EQ(mmu[mmu::IO_REG_IF] & mmu::INT_VBLANK, mmu::INT_VBLANK);
+
+	ppu.run(ppu::CYCLES_PER_FRAME);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_OAM_SCAN);
+	EXPECT_EQ(mmu[ppu::IO_REG_LY], 0);
+
+	mmu[ppu::IO_REG_LCDC] = 0x00;
+	ppu.run(ppu::CYCLES_PER_FRAME + 100);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_HBLANK);
+	EXPECT_EQ(mmu[ppu::IO_REG_LY], 0);
+}
+
+TEST(ppu, background_window_and_sprites)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	write_tile(mmu, 0x8010, 0xff, 0x00);
+	write_tile(mmu, 0x8020, 0xff, 0xff);
+	write_tile(mmu, 0x8030, 0xf0, 0xf0);
+
+	for (std::uint16_t offset = 0; offset < 0x400; ++offset)
+		mmu[0x9800 + offset] = (offset & 1) ? 0x01 : 0x00;
+
+	for (std::uint16_t offset = 0; offset < 0x400; ++offset)
+		mmu[0x9c00 + offset] = 0x02;
+
+	mmu[0xfe00] = 16 + 8;
+	mmu[0xfe01] = 8 + 12;
+	mmu[0xfe02] = 0x03;
+	mmu[0xfe03] = 0x00;
+
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_OBP0] = 0xd2;
+	mmu[ppu::IO_REG_SCX] = 4;
+	mmu[ppu::IO_REG_WY] = 100;
+	mmu[ppu::IO_REG_WX] = 7 + 80;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x40 | 0x20 | 0x10 | 0x02 | 0x01;
+
+	ppu.run(0);
+	ppu.run(ppu::CYCLES_PER_FRAME - 1);
+
+	EXPECT_EQ(ppu.get_frame(), 1);
+
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 0);
+	EXPECT_EQ(get_pixel(ppu, 3, 0), 0);
+	EXPECT_EQ(get_pixel(ppu, 4, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 11, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 12, 0), 0);
+
+	EXPECT_EQ(get_pixel(ppu, 12, 8), 3);
+	EXPECT_EQ(get_pixel(ppu, 15, 8), 3);
+	EXPECT_EQ(get_pixel(ppu, 16, 8), 0);
+	EXPECT_EQ(get_pixel(ppu, 20, 8), 1);
+	EXPECT_EQ(get_pixel(ppu, 12, 16), 0);
+
+	EXPECT_EQ(get_pixel(ppu, 79, 100), 0);
+	EXPECT_EQ(get_pixel(ppu, 80, 100), 3);
+	EXPECT_EQ(get_pixel(ppu, 159, 143), 3);
+	EXPECT_EQ(get_pixel(ppu, 84, 99), 1);
+}
+
+TEST(ppu, tile_cache_invalidation)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	write_tile(mmu, 0x8000, 0xff, 0x00);
+
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x10 | 0x01;
+
+	ppu.run(0);
+	ppu.run(ppu::CYCLES_PER_FRAME);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 0, 1), 1);
+
+	mmu[0x8002] = 0x7f;
+	mmu[0x8003] = 0x80;
+
+	ppu.run(ppu::CYCLES_PER_FRAME * 2);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 0, 1), 2);
+	EXPECT_EQ(get_pixel(ppu, 1, 1), 1);
+}
+
+TEST(pixel_kernels, match_scalar)
+{
+	pixel_kernels scalar{ pixel_kernels::isa::SCALAR };
+	pixel_kernels::rgba_palette palette = { 0xffffffff, 0xffaaaaaa, 0xff555555, 0xff000000 };
+
+	std::vector<std::uint8_t> data(ppu::NUM_TILES * ppu::TILE_SIZE + 6);
+	for (std::size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<std::uint8_t>(i * 37 + (i >> 3));
+
+	std::size_t rows = data.size() / 2;
+	std::vector<std::uint8_t> colors(rows * 8);
+	std::vector<std::uint8_t> shades(colors.size());
+	std::vector<std::uint32_t> pixels(colors.size());
+
+	scalar.decode(data.data(), rows, colors.data());
+	scalar.map(colors.data(), colors.size(), 0xd2, shades.data());
+	scalar.expand(shades.data(), shades.size(), palette, pixels.data());
+
+	EXPECT_EQ(colors[0], ((data[0] >> 7) & 1) | (((data[1] >> 7) & 1) << 1));
+	EXPECT_EQ(shades[0], (0xd2 >> (colors[0] * 2)) & 0x03);
+	EXPECT_EQ(pixels[0], palette[shades[0]]);
+
+	for (auto isa : { pixel_kernels::isa::SSE2, pixel_kernels::isa::AVX2 })
+	{
+		if (!pixel_kernels::is_supported(isa))
+			continue;
+
+		pixel_kernels kernels{ isa };
+		EXPECT_EQ(kernels.get_isa(), isa);
+
+		std::vector<std::uint8_t> simd_colors(colors.size());
+		std::vector<std::uint8_t> simd_shades(colors.size());
+		std::vector<std::uint32_t> simd_pixels(colors.size());
+
+		kernels.decode(data.data(), rows, simd_colors.data());
+		kernels.map(colors.data(), colors.size(), 0xd2, simd_shades.data());
+		kernels.expand(shades.data(), shades.size(), palette, simd_pixels.data());
+
+		EXPECT_EQ(simd_colors, colors);
+		EXPECT_EQ(simd_shades, shades);
+		EXPECT_EQ(simd_pixels, pixels);
+	}
+}
+
+TEST(ppu, skip_unchanged_lines)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	write_tile(mmu, 0x8010, 0xff, 0x00);
+
+	for (std::uint16_t offset = 0; offset < 0x20; ++offset)
+		mmu[0x9800 + offset] = 0x01;
+
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_OBP0] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x10 | 0x02 | 0x01;
+
+	ppu.run(0);
+
+	std::size_t cycle = 0;
+	auto next_frame = [&] { cycle += ppu::CYCLES_PER_FRAME; ppu.run(cycle); };
+
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), 0);
+
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), ppu::SCREEN_HEIGHT);
+
+	mmu[0x8012] = 0x00;
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), ppu::SCREEN_HEIGHT - 8);
+	EXPECT_EQ(get_pixel(ppu, 0, 1), 0);
+	EXPECT_EQ(get_pixel(ppu, 0, 2), 1);
+
+	mmu[0xfe00] = 16 + 40;
+	mmu[0xfe01] = 8;
+	mmu[0xfe02] = 0x01;
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), ppu::SCREEN_HEIGHT - 8);
+	EXPECT_EQ(get_pixel(ppu, 0, 40), 1);
+
+	mmu[0xfe00] = 0;
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), ppu::SCREEN_HEIGHT - 8);
+	EXPECT_EQ(get_pixel(ppu, 0, 40), 0);
+
+	std::size_t version = ppu.get_version();
+	mmu[ppu::IO_REG_SCX] = 1;
+	next_frame();
+	EXPECT_EQ(ppu.get_lines_skipped(), 0);
+	EXPECT_NE(ppu.get_version(), version);
+}
+
+TEST(ppu, render_modes)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	write_tile(mmu, 0x8000, 0xff, 0xff);
+
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x10 | 0x01;
+
+	ppu.set_render_mode(ppu::RENDER_TIMING_ONLY);
+	ppu.run(0);
+
+	ppu.run(ppu::CYCLES_PER_LINE * 10 + ppu::CYCLES_PER_OAM_SCAN);
+	EXPECT_EQ(mmu[ppu::IO_REG_LY], 10);
+	EXPECT_EQ(ppu.get_mode(), ppu::MODE_TRANSFER);
+
+	ppu.run(ppu::CYCLES_PER_FRAME);
+	EXPECT_EQ(ppu.get_frame(), 1);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 0);
+
+	ppu.set_render_mode(ppu::RENDER_INTERVAL, 2);
+	EXPECT_EQ(ppu.get_render_interval(), 2);
+
+	ppu.run(ppu::CYCLES_PER_FRAME * 2);
+	EXPECT_EQ(ppu.get_frame(), 2);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 0);
+
+	ppu.run(ppu::CYCLES_PER_FRAME * 3);
+	EXPECT_EQ(ppu.get_frame(), 3);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 3);
+
+	mmu[ppu::IO_REG_BGP] = 0x00;
+	ppu.run(ppu::CYCLES_PER_FRAME * 4);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 3);
+
+	ppu.set_render_mode(ppu::RENDER_FULL);
+	ppu.run(ppu::CYCLES_PER_FRAME * 5);
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 0);
+}
+
+TEST(ppu, rgba_output)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+	ppu::rgba_palette palette = { 0x11111111, 0x22222222, 0x33333333, 0x44444444 };
+
+	EXPECT_TRUE(ppu.get_rgba_buffer().empty());
+
+	ppu.set_output(ppu::OUTPUT_RGBA32, palette);
+	EXPECT_EQ(ppu.get_output_format(), ppu::OUTPUT_RGBA32);
+
+	auto const& rgba = ppu.get_rgba_buffer();
+	ASSERT_EQ(rgba.size(), ppu::SCREEN_WIDTH * ppu::SCREEN_HEIGHT);
+	EXPECT_EQ(rgba[0], palette[0]);
+
+	write_tile(mmu, 0x8000, 0x0f, 0xff);
+
+	mmu[ppu::IO_REG_BGP] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x10 | 0x01;
+
+	ppu.run(0);
+	ppu.run(ppu::CYCLES_PER_FRAME);
+
+	EXPECT_EQ(rgba[0], palette[2]);
+	EXPECT_EQ(rgba[4], palette[3]);
+	EXPECT_EQ(rgba[ppu::SCREEN_WIDTH * ppu::SCREEN_HEIGHT - 1], palette[3]);
+}
+
+TEST(ppu, sprite_buckets)
+{
+	mmu mmu;
+	ppu ppu{ mmu };
+
+	write_tile(mmu, 0x8010, 0xff, 0x00);
+	write_tile(mmu, 0x8020, 0xff, 0xff);
+
+	for (std::uint16_t index = 0; index < 12; ++index)
+	{
+		mmu[0xfe00 + index * 4] = 16;
+		mmu[0xfe01 + index * 4] = static_cast<std::uint8_t>(8 + index * 8);
+		mmu[0xfe02 + index * 4] = 0x01;
+	}
+
+	mmu[0xfe00 + 12 * 4] = 16 + 20;
+	mmu[0xfe01 + 12 * 4] = 8 + 4;
+	mmu[0xfe02 + 12 * 4] = 0x02;
+	mmu[0xfe00 + 13 * 4] = 16 + 20;
+	mmu[0xfe01 + 13 * 4] = 8;
+	mmu[0xfe02 + 13 * 4] = 0x01;
+
+	mmu[ppu::IO_REG_OBP0] = 0xe4;
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x02;
+
+	std::size_t cycle = 0;
+	auto next_frame = [&] { cycle += ppu::CYCLES_PER_FRAME; ppu.run(cycle); };
+
+	ppu.run(0);
+	next_frame();
+
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 79, 7), 1);
+	EXPECT_EQ(get_pixel(ppu, 80, 0), 0);
+	EXPECT_EQ(get_pixel(ppu, 88, 0), 0);
+	EXPECT_EQ(get_pixel(ppu, 0, 8), 0);
+
+	EXPECT_EQ(get_pixel(ppu, 3, 20), 1);
+	EXPECT_EQ(get_pixel(ppu, 4, 20), 1);
+	EXPECT_EQ(get_pixel(ppu, 8, 20), 3);
+
+	mmu[0xfe00] = 16 + 100;
+	next_frame();
+
+	EXPECT_EQ(get_pixel(ppu, 0, 0), 0);
+	EXPECT_EQ(get_pixel(ppu, 80, 0), 1);
+	EXPECT_EQ(get_pixel(ppu, 0, 100), 1);
+
+	mmu[0xfe01 + 12 * 4] = 8;
+	next_frame();
+
+	EXPECT_EQ(get_pixel(ppu, 4, 20), 3);
+
+	mmu[0xfe01 + 13 * 4] = 9;
+	next_frame();
+
+	EXPECT_EQ(get_pixel(ppu, 0, 20), 3);
+	EXPECT_EQ(get_pixel(ppu, 8, 20), 1);
+
+	mmu[ppu::IO_REG_LCDC] = 0x80 | 0x04 | 0x02;
+	next_frame();
+
+	EXPECT_EQ(get_pixel(ppu, 8, 7), 0);
+	EXPECT_EQ(get_pixel(ppu, 8, 15), 1);
+}
+
+TEST(ppu, catch_up_matches_lockstep)
+{
+	mmu catch_up_mmu;
+	ppu catch_up_ppu{ catch_up_mmu };
+	lr35902 catch_up_cpu{ catch_up_mmu, catch_up_ppu };
+
+	mmu lockstep_mmu;
+	ppu lockstep_ppu{ lockstep_mmu };
+	lr35902 lockstep_cpu{ lockstep_mmu, lockstep_ppu };
+
+	catch_up_mmu.set_cartridge({ 0x10 });
+	lockstep_mmu.set_cartridge({ 0x10 });
+
+	for (std::size_t step = 0; step < 100000; ++step)
+	{
+		catch_up_cpu.step();
+		lockstep_cpu.step();
+		lockstep_ppu.run(lockstep_cpu.get_cycle());
+
+		if (step % 1000 == 0)
+		{
+			ASSERT_EQ(catch_up_mmu[ppu::IO_REG_LY], lockstep_mmu[ppu::IO_REG_LY]);
+		}
+	}
+
+	catch_up_ppu.run(catch_up_cpu.get_cycle());
+
+	EXPECT_EQ(catch_up_cpu.get_register(lr35902::r16::PC), lockstep_cpu.get_register(lr35902::r16::PC));
+	EXPECT_EQ(catch_up_cpu.get_cycle(), lockstep_cpu.get_cycle());
+	EXPECT_EQ(catch_up_ppu.get_frame(), lockstep_ppu.get_frame());
+	EXPECT_EQ(catch_up_ppu.get_line(), lockstep_ppu.get_line());
+	EXPECT_EQ(catch_up_ppu.get_mode(), lockstep_ppu.get_mode());
+	EXPECT_EQ(catch_up_mmu.get_io(mmu::IO_REG_IF), lockstep_mmu.get_io(mmu::IO_REG_IF));
+	EXPECT_EQ(catch_up_ppu.get_video_ram(), lockstep_ppu.get_video_ram());
+}
+
+TEST(ppu, parallel_raster_matches_serial)
+{
+	mmu serial_mmu;
+	ppu serial_ppu{ serial_mmu };
+
+	mmu parallel_mmu;
+	ppu parallel_ppu{ parallel_mmu };
+	parallel_ppu.set_raster_threads(3);
+	parallel_ppu.set_output(ppu::OUTPUT_RGBA32, { 1, 2, 3, 4 });
+	serial_ppu.set_output(ppu::OUTPUT_RGBA32, { 1, 2, 3, 4 });
+
+	EXPECT_EQ(parallel_ppu.get_raster_threads(), 3);
+	EXPECT_EQ(serial_ppu.get_raster_threads(), 0);
+
+	auto both = [&](auto&& action) { action(serial_mmu); action(parallel_mmu); };
+
+	both([](mmu& mmu)
+	{
+		for (std::uint16_t tile = 0; tile < 16; ++tile)
+			write_tile(mmu, 0x8000 + tile * 16, static_cast<std::uint8_t>(tile * 17), static_cast<std::uint8_t>(~tile * 5));
+
+		for (std::uint16_t offset = 0; offset < 0x800; ++offset)
+			mmu[0x9800 + offset] = offset % 13;
+
+		for (std::uint16_t index = 0; index < ppu::NUM_SPRITES; ++index)
+		{
+			mmu[0xfe00 + index * 4] = static_cast<std::uint8_t>(16 + index * 3);
+			mmu[0xfe01 + index * 4] = static_cast<std::uint8_t>(index * 11);
+			mmu[0xfe02 + index * 4] = static_cast<std::uint8_t>(index % 16);
+			mmu[0xfe03 + index * 4] = static_cast<std::uint8_t>(index << 4);
+		}
+
+		for (std::uint16_t index = 0; index < ppu::NUM_SPRITES; ++index)
+		{
+			mmu[0xc000 + index * 4] = static_cast<std::uint8_t>(16 + 140 - index * 3);
+			mmu[0xc001 + index * 4] = static_cast<std::uint8_t>(160 - index * 4);
+			mmu[0xc002 + index * 4] = static_cast<std::uint8_t>(15 - index % 16);
+			mmu[0xc003 + index * 4] = static_cast<std::uint8_t>(~index << 4);
+		}
+
+		mmu[ppu::IO_REG_BGP] = 0xe4;
+		mmu[ppu::IO_REG_OBP0] = 0xd2;
+		mmu[ppu::IO_REG_OBP1] = 0x1b;
+		mmu[ppu::IO_REG_WY] = 60;
+		mmu[ppu::IO_REG_WX] = 50;
+		mmu[ppu::IO_REG_LCDC] = 0x80 | 0x40 | 0x20 | 0x10 | 0x02 | 0x01;
+	});
+
+	serial_ppu.run(0);
+	parallel_ppu.run(0);
+
+	for (std::size_t line = 1; line <= ppu::NUM_SCAN_LINES * 3; ++line)
+	{
+		both([line](mmu& mmu)
+		{
+			mmu[ppu::IO_REG_SCX] = static_cast<std::uint8_t>(line * 3);
+
+			if (line % 50 == 0)
+				write_tile(mmu, 0x8030, static_cast<std::uint8_t>(line), 0x55);
+
+			if (line % 70 == 0)
+				mmu[0xfe05] = static_cast<std::uint8_t>(line);
+
+			if (line == ppu::NUM_SCAN_LINES * 2 + 100)
+				mmu[ppu::IO_REG_DMA] = 0xc0;
+		});
+
+		serial_ppu.run(line * ppu::CYCLES_PER_LINE);
+		parallel_ppu.run(line * ppu::CYCLES_PER_LINE);
+		both([line](mmu& mmu) { mmu.get_scheduler().run(line * ppu::CYCLES_PER_LINE); });
+	}
+
+	EXPECT_EQ(parallel_ppu.get_frame(), 3);
+	EXPECT_EQ(parallel_ppu.get_version(), serial_ppu.get_version());
+	EXPECT_EQ(parallel_ppu.get_video_ram(), serial_ppu.get_video_ram());
+	EXPECT_EQ(parallel_ppu.get_rgba_buffer(), serial_ppu.get_rgba_buffer());
+
+	auto& serial_frames = serial_ppu.get_frames();
+	auto& parallel_frames = parallel_ppu.get_frames();
+
+	ASSERT_TRUE(serial_frames.acquire());
+	ASSERT_TRUE(parallel_frames.acquire());
+	EXPECT_EQ(parallel_frames.get_front().shades_, serial_frames.get_front().shades_);
+	EXPECT_EQ(parallel_frames.get_front().rgba_, serial_frames.get_front().rgba_);
+}
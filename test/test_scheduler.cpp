@@ -0,0 +1,89 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <naive_gbe/scheduler.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	struct fired
+	{
+		scheduler::event	id_;
+		std::uint64_t		cycle_;
+	};
+
+	struct recorder
+	{
+		std::vector<fired>	fired_;
+	};
+
+	template <scheduler::event Id>
+	void on_event(void* context, std::uint64_t cycle)
+	{
+		auto self = static_cast<recorder*>(context);
+
+		self->fired_.push_back({ Id, cycle });
+	}
+}
+
+TEST(scheduler, dispatch_in_order)
+{
+	scheduler scheduler;
+	recorder recorder;
+
+	scheduler.schedule(scheduler::EVENT_APU, 200, &on_event<scheduler::EVENT_APU>, &recorder);
+	scheduler.schedule(scheduler::EVENT_PPU, 100, &on_event<scheduler::EVENT_PPU>, &recorder);
+	scheduler.schedule(scheduler::EVENT_DMA_END, 150, &on_event<scheduler::EVENT_DMA_END>, &recorder);
+
+	EXPECT_EQ(scheduler.get_next_cycle(), 100);
+
+	scheduler.run(99);
+	EXPECT_TRUE(recorder.fired_.empty());
+
+	scheduler.run(250);
+	ASSERT_EQ(recorder.fired_.size(), 3);
+	EXPECT_EQ(recorder.fired_[0].id_, scheduler::EVENT_PPU);
+	EXPECT_EQ(recorder.fired_[1].id_, scheduler::EVENT_DMA_END);
+	EXPECT_EQ(recorder.fired_[2].id_, scheduler::EVENT_APU);
+	EXPECT_EQ(scheduler.get_next_cycle(), scheduler::NEVER);
+}
+
+TEST(scheduler, reschedule_later)
+{
+	scheduler scheduler;
+	recorder recorder;
+
+	scheduler.schedule(scheduler::EVENT_PPU, 100, &on_event<scheduler::EVENT_PPU>, &recorder);
+	scheduler.schedule(scheduler::EVENT_APU, 200, &on_event<scheduler::EVENT_APU>, &recorder);
+	scheduler.schedule(scheduler::EVENT_PPU, 300, &on_event<scheduler::EVENT_PPU>, &recorder);
+
+	EXPECT_EQ(scheduler.get_next_cycle(), 200);
+
+	scheduler.run(100);
+	EXPECT_TRUE(recorder.fired_.empty());
+
+	scheduler.run(200);
+	ASSERT_EQ(recorder.fired_.size(), 1);
+	EXPECT_EQ(recorder.fired_[0].id_, scheduler::EVENT_APU);
+
+	scheduler.run(300);
+	ASSERT_EQ(recorder.fired_.size(), 2);
+	EXPECT_EQ(recorder.fired_[1].id_, scheduler::EVENT_PPU);
+	EXPECT_EQ(recorder.fired_[1].cycle_, 300);
+
+	// Moving a later event earlier still pulls the next cycle in.
+	scheduler.schedule(scheduler::EVENT_DMA_END, 500, &on_event<scheduler::EVENT_DMA_END>, &recorder);
+	scheduler.schedule(scheduler::EVENT_APU, 600, &on_event<scheduler::EVENT_APU>, &recorder);
+	scheduler.schedule(scheduler::EVENT_APU, 400, &on_event<scheduler::EVENT_APU>, &recorder);
+	EXPECT_EQ(scheduler.get_next_cycle(), 400);
+
+	scheduler.cancel(scheduler::EVENT_APU);
+	EXPECT_EQ(scheduler.get_next_cycle(), 500);
+}
@@ -0,0 +1,31 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <naive_gbe/speed_meter.hpp>
+using namespace naive_gbe;
+
+TEST(speed_meter, frame_time_and_speed)
+{
+	using namespace std::chrono;
+	speed_meter meter;
+	auto now = speed_meter::clock::now();
+
+	// Two frames per 10 ms slice with 4 ms of it busy; the second window starts on a slice boundary.
+	for (int slice = 0; slice < 16; ++slice)
+	{
+		now += milliseconds{ 10 };
+		meter.add(ppu::CYCLES_PER_FRAME * 2, milliseconds{ 4 }, now);
+	}
+
+	EXPECT_EQ(meter.get_frame_time(), milliseconds{ 2 });
+	EXPECT_NEAR(meter.get_speed(), 2.0 * ppu::CYCLES_PER_FRAME / (0.010 * ppu::CYCLES_PER_SECOND), 0.01);
+
+	now += seconds{ 5 };
+	meter.add(speed_meter::WINDOW_CYCLES, milliseconds{ 250 }, now);
+	EXPECT_NEAR(meter.get_speed(), 1.0, 0.01);
+}
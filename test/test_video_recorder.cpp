@@ -0,0 +1,140 @@
+//
+//            Copyright (c) Marco Amorim 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <naive_gbe/emulator.hpp>
+using namespace naive_gbe;
+
+namespace
+{
+	std::string read_file(std::string const& file_name)
+	{
+		std::ifstream ifs(file_name, std::ios::binary);
+		std::ostringstream oss;
+
+		oss << ifs.rdbuf();
+
+		return oss.str();
+	}
+}
+
+TEST(video_recorder, y4m)
+{
+	std::string file_name = testing::TempDir() + "naive_gbe_video.y4m";
+	std::vector<std::uint8_t> shades(video_recorder::FRAME_PIXELS, 3);
+	std::error_code ec;
+
+	shades[1] = 0;
+
+	video_recorder recorder;
+	ASSERT_TRUE(recorder.start(file_name, video_recorder::FORMAT_Y4M, ec));
+	EXPECT_TRUE(recorder.is_recording());
+
+	std::size_t pushed = 0;
+
+	for (std::size_t frame = 0; frame < 10; ++frame)
+		pushed += recorder.push(shades.data(), frame);
+
+	ASSERT_TRUE(recorder.stop(ec));
+	EXPECT_FALSE(recorder.is_recording());
+	EXPECT_EQ(recorder.get_recorded(), pushed);
+	EXPECT_EQ(recorder.get_recorded() + recorder.get_dropped(), 10);
+
+	std::string data = read_file(file_name);
+	std::string header = "YUV4MPEG2 W160 H144 F4194304:70224 Ip A1:1 C420jpeg\n";
+	std::size_t frame_size = 6 + video_recorder::FRAME_PIXELS * 3 / 2;
+
+	ASSERT_EQ(data.size(), header.size() + pushed * frame_size);
+	EXPECT_EQ(data.substr(0, header.size()), header);
+	EXPECT_EQ(data.substr(header.size(), 6), "FRAME\n");
+	EXPECT_EQ(static_cast<std::uint8_t>(data[header.size() + 6]), 0x00);
+	EXPECT_EQ(static_cast<std::uint8_t>(data[header.size() + 7]), 0xff);
+	EXPECT_EQ(static_cast<std::uint8_t>(data.back()), 0x80);
+
+	std::remove(file_name.c_str());
+}
+
+TEST(video_recorder, rgba_with_index)
+{
+	std::string file_name = testing::TempDir() + "naive_gbe_video.rgba";
+	std::vector<std::uint8_t> shades(video_recorder::FRAME_PIXELS, 1);
+	std::error_code ec;
+
+	video_recorder recorder{ 2 };
+	recorder.set_palette({ 1, 2, 3, 4 });
+	ASSERT_TRUE(recorder.start(file_name, video_recorder::FORMAT_RGBA, ec));
+
+	// Palette changes while recording apply from the next pushed frame on.
+	for (std::size_t frame = 0; frame < 1000; ++frame)
+	{
+		recorder.set_palette({ 1, static_cast<std::uint32_t>(2 + frame % 2), 3, 4 });
+		recorder.push(shades.data(), frame);
+	}
+
+	ASSERT_TRUE(recorder.stop(ec));
+	EXPECT_EQ(recorder.get_recorded() + recorder.get_dropped(), 1000);
+
+	std::size_t frame_size = video_recorder::FRAME_PIXELS * sizeof(std::uint32_t);
+	std::string data = read_file(file_name);
+
+	ASSERT_EQ(data.size(), recorder.get_recorded() * frame_size);
+
+	std::istringstream index(read_file(file_name + ".idx"));
+	std::size_t frame = 0;
+	std::size_t offset = 0;
+	std::size_t entries = 0;
+	std::size_t last = 0;
+
+	while (index >> frame >> offset)
+	{
+		EXPECT_EQ(offset, entries * frame_size);
+		EXPECT_EQ(data[offset], static_cast<char>(2 + frame % 2));
+		EXPECT_TRUE(entries == 0 || frame > last);
+		last = frame;
+		++entries;
+	}
+
+	EXPECT_EQ(entries, recorder.get_recorded());
+
+	std::remove(file_name.c_str());
+	std::remove((file_name + ".idx").c_str());
+}
+
+TEST(video_recorder, emulator_frames)
+{
+	std::string file_name = testing::TempDir() + "naive_gbe_emulator.y4m";
+	std::error_code ec;
+
+	emulator emu;
+	emu.set_cartridge({ 0x10 });
+
+	ASSERT_TRUE(emu.start_recording(file_name, video_recorder::FORMAT_Y4M, ec));
+
+	auto& cpu = emu.get_cpu();
+
+	while (emu.get_ppu().get_frame() < 3)
+		cpu.step();
+
+	ASSERT_TRUE(emu.stop_recording(ec));
+	EXPECT_EQ(emu.get_recorder().get_recorded() + emu.get_recorder().get_dropped(), 3);
+	EXPECT_FALSE(emu.get_recorder().is_recording());
+
+	std::remove(file_name.c_str());
+}
+
+TEST(video_recorder, open_failure)
+{
+	std::error_code ec;
+	video_recorder recorder;
+
+	EXPECT_FALSE(recorder.start(testing::TempDir() + "missing/dir/video.y4m", video_recorder::FORMAT_Y4M, ec));
+	EXPECT_TRUE(ec);
+	EXPECT_FALSE(recorder.is_recording());
+}